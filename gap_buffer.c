@@ -0,0 +1,93 @@
+#include "gap_buffer.h"
+#include <string.h>
+
+// Helper: Move the gap so it starts at pos, copying the text in between across it
+static void gap_buffer_move_gap(GapBuffer* buffer, size_t pos) {
+    size_t gap = buffer->gap_end - buffer->gap_start;
+    if(pos < buffer->gap_start) {
+        size_t count = buffer->gap_start - pos;
+        memmove(buffer->data + pos + gap, buffer->data + pos, count);
+    } else if(pos > buffer->gap_start) {
+        size_t count = pos - buffer->gap_start;
+        memmove(buffer->data + buffer->gap_start, buffer->data + buffer->gap_end, count);
+    }
+    buffer->gap_start = pos;
+    buffer->gap_end = pos + gap;
+    buffer->data[pos] = '\0';
+}
+
+void gap_buffer_init(GapBuffer* buffer, size_t capacity) {
+    buffer->size = capacity + 1;
+    buffer->data = malloc(buffer->size);
+    buffer->gap_start = 0;
+    buffer->gap_end = buffer->size;
+    buffer->data[0] = '\0';
+}
+
+void gap_buffer_free(GapBuffer* buffer) {
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->gap_start = 0;
+    buffer->gap_end = 0;
+}
+
+size_t gap_buffer_length(const GapBuffer* buffer) {
+    return buffer->size - (buffer->gap_end - buffer->gap_start);
+}
+
+size_t gap_buffer_space(const GapBuffer* buffer) {
+    // One byte of the gap is kept for the terminator
+    return buffer->gap_end - buffer->gap_start - 1;
+}
+
+char gap_buffer_char_at(const GapBuffer* buffer, size_t index) {
+    if(index < buffer->gap_start) return buffer->data[index];
+    return buffer->data[index + (buffer->gap_end - buffer->gap_start)];
+}
+
+size_t gap_buffer_insert(GapBuffer* buffer, size_t pos, const char* text, size_t len) {
+    size_t space = gap_buffer_space(buffer);
+    if(len > space) len = space;
+    if(len == 0) return 0;
+
+    gap_buffer_move_gap(buffer, pos);
+    memcpy(buffer->data + buffer->gap_start, text, len);
+    buffer->gap_start += len;
+    buffer->data[buffer->gap_start] = '\0';
+    return len;
+}
+
+void gap_buffer_delete(GapBuffer* buffer, size_t pos, size_t count) {
+    if(count > pos) count = pos;
+    if(count == 0) return;
+
+    gap_buffer_move_gap(buffer, pos);
+    buffer->gap_start -= count;
+    buffer->data[buffer->gap_start] = '\0';
+}
+
+const char* gap_buffer_prefix(GapBuffer* buffer, size_t pos) {
+    gap_buffer_move_gap(buffer, pos);
+    return buffer->data;
+}
+
+const char* gap_buffer_text(GapBuffer* buffer) {
+    return gap_buffer_prefix(buffer, gap_buffer_length(buffer));
+}
+
+void gap_buffer_set(GapBuffer* buffer, const char* text) {
+    size_t len = strlen(text);
+    if(len > buffer->size - 1) len = buffer->size - 1;
+
+    memcpy(buffer->data, text, len);
+    buffer->gap_start = len;
+    buffer->gap_end = buffer->size;
+    buffer->data[len] = '\0';
+}
+
+const char* gap_buffer_flat(const GapBuffer* buffer) {
+    // Only a gap at the end leaves the text in one piece
+    furi_check(buffer->gap_end == buffer->size);
+    return buffer->data;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <furi.h>
+
+/**
+ * @brief Editable text with a movable gap of free space
+ *
+ * The text is stored as data[0, gap_start) followed by data[gap_end, size). Edits happen
+ * at the gap, which is moved to the edit position first, so typing, deleting and replacing
+ * at the caret cost O(edit length) however long the text is; only moving the gap copies
+ * text, proportional to the distance moved. The first byte of the gap is always a NUL, so
+ * the text before the gap reads as a string. Treat the fields as private.
+ */
+typedef struct {
+    char* data;
+    size_t size;      // Bytes allocated: the capacity plus one, so a NUL always fits
+    size_t gap_start;
+    size_t gap_end;
+} GapBuffer;
+
+/**
+ * @brief Allocate an empty buffer
+ *
+ * @param buffer Buffer to initialize
+ * @param capacity Maximum number of characters it holds
+ */
+void gap_buffer_init(GapBuffer* buffer, size_t capacity);
+
+/**
+ * @brief Release a buffer's memory
+ *
+ * @param buffer Buffer to free
+ */
+void gap_buffer_free(GapBuffer* buffer);
+
+/**
+ * @brief Get the number of characters in a buffer
+ *
+ * @param buffer Buffer
+ * @return Text length
+ */
+size_t gap_buffer_length(const GapBuffer* buffer);
+
+/**
+ * @brief Get the number of characters that can still be inserted
+ *
+ * @param buffer Buffer
+ * @return Free space in characters
+ */
+size_t gap_buffer_space(const GapBuffer* buffer);
+
+/**
+ * @brief Get one character of a buffer without moving the gap
+ *
+ * @param buffer Buffer
+ * @param index Position in the text, less than its length
+ * @return Character at index
+ */
+char gap_buffer_char_at(const GapBuffer* buffer, size_t index);
+
+/**
+ * @brief Insert characters into a buffer, as far as they fit
+ *
+ * @param buffer Buffer
+ * @param pos Position in the text to insert at
+ * @param text Characters to insert
+ * @param len Number of characters
+ * @return Number of characters inserted, less than len if the buffer is full
+ */
+size_t gap_buffer_insert(GapBuffer* buffer, size_t pos, const char* text, size_t len);
+
+/**
+ * @brief Delete the characters before a position, as backspace does
+ *
+ * @param buffer Buffer
+ * @param pos Position in the text to delete before
+ * @param count Number of characters, at most pos
+ */
+void gap_buffer_delete(GapBuffer* buffer, size_t pos, size_t count);
+
+/**
+ * @brief Get the text before a position as one NUL-terminated string
+ *
+ * Moves the gap to pos. The pointer is valid until the buffer is next changed or accessed
+ * through this function or gap_buffer_text().
+ *
+ * @param buffer Buffer
+ * @param pos Position in the text
+ * @return The first pos characters of the text
+ */
+const char* gap_buffer_prefix(GapBuffer* buffer, size_t pos);
+
+/**
+ * @brief Get the whole text as one NUL-terminated string
+ *
+ * Moves the gap to the end, see gap_buffer_prefix().
+ *
+ * @param buffer Buffer
+ * @return The text
+ */
+const char* gap_buffer_text(GapBuffer* buffer);
+
+/**
+ * @brief Replace the whole text of a buffer
+ *
+ * @param buffer Buffer
+ * @param text New text, truncated to the buffer's capacity
+ */
+void gap_buffer_set(GapBuffer* buffer, const char* text);
+
+/**
+ * @brief Read the whole text of a buffer whose gap is already at the end
+ *
+ * Unlike gap_buffer_text() it does not change the buffer, so it is safe where only reading
+ * is allowed, such as a draw callback. gap_buffer_text() or gap_buffer_set() leave the gap
+ * at the end; it is checked.
+ *
+ * @param buffer Buffer
+ * @return The text, valid until the buffer is next changed
+ */
+const char* gap_buffer_flat(const GapBuffer* buffer);
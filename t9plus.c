@@ -4,330 +4,3024 @@
 #include <ctype.h>
 #include <string.h>
 
+#if T9PLUS_STATS
+#include <furi_hal.h>
+#endif
+
 #define TAG "T9Plus"
 
 // Maximum words per tier
 #define MAX_TIER_WORDS 1000
 #define MAX_WORD_LEN 32
 
+// Data file locations
+#define T9PLUS_DATA_DIR "/ext/apps_data/type_aid/data"
+#define T9PLUS_UNIGRAM_PATH T9PLUS_DATA_DIR "/unigram_1000.txt"
+
+// Compiled data files of a language pack, formatted with the pack's suffix by PACK_PATH()
+#define T9PLUS_LEXICON_FILE "lexicon%s.t9l"
+#define T9PLUS_BIGRAM_FILE "bigrams%s.t9b"
+#define T9PLUS_FRAMES_FILE "frames%s.t9f"
+#define T9PLUS_DICT_FILE "dictionary%s.t9d"
+#define PACK_PATH_SIZE 64
+#define PACK_PATH(path, file, language) \
+    snprintf(path, sizeof(path), T9PLUS_DATA_DIR "/" file, language_packs[language].suffix)
+
+// Words learned from the user, kept next to the data directory
+#define T9PLUS_USER_WORDS_PATH "/ext/apps_data/type_aid/user_words.txt"
+#define T9PLUS_USER_WORDS_TEMP_PATH "/ext/apps_data/type_aid/user_words.tmp"
+
+// Lexicon built from the text tiers, kept from the last run so the next one need not rebuild it
+#define T9PLUS_SNAPSHOT_PATH "/ext/apps_data/type_aid/lexicon_cache.t9s"
+#define T9PLUS_SNAPSHOT_TEMP_PATH "/ext/apps_data/type_aid/lexicon_cache.tmp"
+
+// Block size used when reading plain-text tier files
+#define READ_CHUNK_SIZE 512
+
+// Stack of the background loader thread: storage calls, qsort() and logging
+#define LOADER_STACK_SIZE (4 * 1024)
+
+// Compiled lexicon format, produced by tools/build_lexicon.py:
+//   T9LexHeader | primary arena | deferred arena
+// Each arena is loaded into RAM as is and holds the tiers of one part and their prefix trie:
+//   T9LexTable | per tier: uint16_t offsets[count], uint16_t ranks[count], uint8_t scores[count],
+//   packed NUL-terminated words | '\0' padding | uint32_t keys[entry_count] | T9LexNode[node_count]
+// Words are lowercase and sorted bytewise; ranks[i] is the word's line index in its source
+// file, so the original within-tier order survives the sort, plus the mask of the tiers that
+// list the word and its capitalization flag. scores[i] is the word's one-byte score, see
+// word_score(). Word offsets are relative to the tier's words_offset. All offsets are
+// little-endian. keys[ref] is the ordering key of each entry ref of the part, see entry_key(),
+// packed into one table so ranking candidates reads one word per candidate.
+// Each word is stored once in the whole lexicon, in the listing tier of best priority, so no
+// two entries of either part spell the same word.
+// Tiers are stored as tier1, tier2, tier3a, tier3b, tier4; tiers of the other part are empty.
+// The header holds an FNV-1a checksum of each arena, checked once the arena is read.
+//
+// The primary part holds tier1, tier3a and tier3b, which answer most lookups and are loaded
+// first. The deferred part holds the low-priority tiers tier2 and tier4 and is loaded after it.
+//
+// Entries of a part's tiers are numbered consecutively in that order (entry refs). The trie
+// is path-compressed over all entries of the part; each node caches the entry refs of its best
+// completions by entry_key(), so a lookup only walks the prefix and merges the cached
+// completions of both parts.
+#define T9LEX_MAGIC 0x584C3954 // "T9LX"
+#define T9LEX_VERSION 9
+#define T9LEX_TIER_COUNT 5
+#define T9LEX_PART_COUNT 2
+#define T9LEX_TOP_COUNT 3
+#define T9LEX_NONE 0xFFFF
+
+// Rank fields: the line index, below MAX_TIER_WORDS; bit T9LEX_RANK_TIERS_SHIFT + t for each
+// tier t (lexicon order) listing the word; and a flag for a source word that started with an
+// uppercase letter ("I")
+#define T9LEX_RANK_MASK 0x03FF
+#define T9LEX_RANK_TIERS_SHIFT 10
+#define T9LEX_RANK_CAPITALIZED 0x8000
+
+// Word scores, lower is better: the word's position in the unigram list, SCORE_UNIGRAM_STEP
+// positions per step, or SCORE_UNKNOWN if it is not listed, plus SCORE_TIER_STEP per step of
+// tier priority. Only the first MAX_TIER_WORDS lines of the unigram list are used.
+#define SCORE_UNIGRAM_STEP 5
+#define SCORE_UNKNOWN (MAX_TIER_WORDS / SCORE_UNIGRAM_STEP)
+#define SCORE_TIER_STEP 4
+
+// Lexicon parts, in file order
+#define LEXICON_PRIMARY 0
+#define LEXICON_DEFERRED 1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t tier_count;
+    uint32_t arena_size[T9LEX_PART_COUNT]; // Size of each part's arena in bytes, in file order
+    uint32_t checksum[T9LEX_PART_COUNT];   // FNV-1a hash of each part's arena
+} T9LexHeader;
+
+// Warm-start snapshot, written by t9plus_deinit() when the default pack was built from its
+// text tiers:
+//   T9SnapHeader | T9LexHeader | primary arena | deferred arena
+// After its own header the snapshot is a compiled lexicon of the built arenas, so a part is
+// restored with one block read. It is only used while the size and timestamp of every source
+// file still match those it was built from; otherwise the part is rebuilt from the text.
+#define T9SNAP_MAGIC 0x4E533954 // "T9SN"
+#define T9SNAP_VERSION 1
+#define T9SNAP_SOURCE_COUNT (T9LEX_TIER_COUNT + 1) // The tier files, then the unigram list
+
+typedef struct {
+    uint32_t size[T9SNAP_SOURCE_COUNT];
+    uint32_t timestamp[T9SNAP_SOURCE_COUNT];
+} T9SnapStamp;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t source_count;
+    T9SnapStamp sources;
+} T9SnapHeader;
+
+typedef struct {
+    uint32_t index_offset; // Arena offset of the tier's uint16_t word offsets
+    uint32_t ranks_offset; // Arena offset of the tier's uint16_t ranks
+    uint32_t scores_offset; // Arena offset of the tier's uint8_t scores
+    uint32_t words_offset; // Arena offset of the tier's packed words
+    uint32_t count;        // Number of words in the tier
+} T9LexTierEntry;
+
+typedef struct {
+    T9LexTierEntry tiers[T9LEX_TIER_COUNT];
+    uint32_t nodes_offset; // Arena offset of the trie nodes, root first
+    uint32_t node_count;
+    uint32_t keys_offset;  // Arena offset of the uint32_t ordering key of each entry ref; the word data ends here
+} T9LexTable;
+
+typedef struct {
+    uint16_t label_ref;   // Entry whose word spells the edge label
+    uint8_t label_len;    // Edge label length; the label starts at the parent's depth
+    uint8_t child_count;
+    uint16_t first_child; // Children are stored contiguously
+    uint16_t top[T9LEX_TOP_COUNT]; // Best completions by tier priority, T9LEX_NONE if unused
+} T9LexNode;
+
+// Bigram table, produced by tools/build_lexicon.py from data/bigrams.tsv:
+//   T9BigramHeader | T9BigramRecord[record_count]
+// Records are sorted bytewise by their lowercase previous word and hold its best next words,
+// best first, as typed (e.g. "I"). All words are NUL-padded. The table stays on the SD card;
+// a lookup binary searches it with one seek and one record read per step.
+#define T9BG_MAGIC 0x47423954 // "T9BG"
+#define T9BG_VERSION 1
+#define T9BG_WORD_SIZE 12 // Word field size, so words of up to 11 characters
+#define T9BG_NEXT_COUNT 3
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size; // sizeof(T9BigramRecord)
+    uint32_t record_count;
+} T9BigramHeader;
+
+typedef struct {
+    char prev[T9BG_WORD_SIZE];
+    char next[T9BG_NEXT_COUNT][T9BG_WORD_SIZE]; // Empty fields after the last next word
+} T9BigramRecord;
+
+// Frame tables, produced by tools/build_lexicon.py from frames.tsv, frame_sets.tsv and
+// gating_rules.tsv:
+//   T9FrameHeader | T9FrameGate[gate_count] | T9Frame[frame_count] | T9FrameWord[word_count]
+// Every token set, literal frame token ("it") and gate token list has a set bit, and each word
+// stores the mask of the sets it belongs to, sorted bytewise by the lowercase word. A frame is
+// a sequence of set bits; when the words before the current one fill its first slots, words of
+// the next slot become candidates while the frame's gate is open. Boosts are stored as Q8
+// score scales (T9FR_SCALE_ONE / boost), so applying one is a multiply and a shift.
+#define T9FR_MAGIC 0x52463954 // "T9FR"
+#define T9FR_VERSION 1
+#define T9FR_WORD_SIZE 12
+#define T9FR_MAX_SLOTS 4
+#define T9FR_SCALE_ONE 256
+
+// Gate flags
+#define T9FR_GATE_ALWAYS 0x01   // Always open
+#define T9FR_GATE_QUESTION 0x02 // Open in a question
+#define T9FR_NO_SENTENCE_LEN 0xFF
+
+// Register and punctuation bits of the gating context, in the compiler's order
+#define T9FR_REGISTER_CHAT 0x01
+#define T9FR_REGISTER_CASUAL 0x02
+#define T9FR_REGISTER_FORMAL 0x04
+static const char frame_punct[] = ".,!?:;";
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t gate_count;
+    uint8_t frame_count;
+    uint16_t word_count;
+    uint8_t set_count;
+    uint8_t reserved;
+} T9FrameHeader;
+
+// A gate is open if any of its conditions holds
+typedef struct {
+    uint32_t token_mask;     // Sets of which the previous word must be in one
+    uint16_t score_scale;    // Q8 factor applied to the scores of the words it boosts
+    uint8_t flags;           // T9FR_GATE_*
+    uint8_t register_mask;   // Registers that open it
+    uint8_t punct_mask;      // Punctuation before the current word that opens it
+    uint8_t min_sentence_len; // Sentence length that opens it, T9FR_NO_SENTENCE_LEN for none
+    uint8_t reserved[2];
+} T9FrameGate;
+
+typedef struct {
+    uint8_t gate;
+    uint8_t register_mask; // Registers the frame applies to, 0 for any
+    uint8_t slot_count;
+    uint8_t slots[T9FR_MAX_SLOTS]; // Set bit of each token
+    uint8_t reserved;
+} T9Frame;
+
+typedef struct {
+    char word[T9FR_WORD_SIZE];
+    uint32_t sets;
+} T9FrameWord;
+
+// Block-indexed dictionary, produced by tools/build_lexicon.py from a frequency-ordered word
+// list of any size. It stays on the SD card and is read in T9DX_BLOCK_SIZE blocks:
+//   blocks 0..tops_block-1: T9DictHeader | uint16_t index[T9DX_BUCKETS + 1]
+//   blocks tops_block..words_block-1: T9DictTop[T9DX_TOP_RECORDS]
+//   blocks words_block..last: uint8_t count | entries
+// Words are lowercase and sorted bytewise; an entry is uint16_t rank (lower is more frequent),
+// uint8_t length with T9DX_CAPITALIZED, then the word. index[b] is the block holding the
+// first word of bucket b, by the classes of its first two characters (see dict_class());
+// index[T9DX_BUCKETS] is the last block. Prefixes of one or two letters span too many blocks
+// to scan, so their best words are precomputed as block << 16 | offset refs.
+// Only the index and a few cached blocks are held in RAM, whatever the dictionary's size.
+#define T9DX_MAGIC 0x58443954 // "T9DX"
+#define T9DX_VERSION 1
+#define T9DX_BLOCK_SIZE 512
+#define T9DX_CLASSES 28
+#define T9DX_BUCKETS (T9DX_CLASSES * T9DX_CLASSES)
+#define T9DX_TOP_RECORDS (T9DX_BUCKETS + T9DX_CLASSES) // Then one per first character
+#define T9DX_TOP_COUNT 3
+#define T9DX_NO_REF 0xFFFFFFFF
+#define T9DX_CAPITALIZED 0x80
+#define T9DX_LENGTH_MASK 0x7F
+#define T9DX_ENTRY_HEADER 3
+
+// Blocks held by the LRU block cache, and blocks a prefix scan may read
+#define DICT_CACHE_BLOCKS 4
+#define DICT_MAX_SCAN_BLOCKS 4
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t block_size;
+    uint32_t word_count;
+    uint16_t tops_block;  // First block of the top records
+    uint16_t words_block; // First block of words
+} T9DictHeader;
+
+typedef struct {
+    uint32_t refs[T9DX_TOP_COUNT]; // Best words by rank, T9DX_NO_REF if unused
+    uint32_t reserved;
+} T9DictTop;
+
+typedef struct {
+    uint8_t data[T9DX_BLOCK_SIZE];
+    uint16_t block;
+    uint32_t last_used; // Cache clock at the last access, 0 if the slot is empty
+} DictCacheSlot;
+
+// Dictionary word decoded from a block
+typedef struct {
+    uint16_t rank;
+    char word[MAX_WORD_LEN]; // As it should be suggested, capitalization restored
+} DictWord;
+
+// Gating context of the current word. Set masks of the words before it, most recent first,
+// are looked up once per finished word, so evaluating the gates needs no string work.
+// A frame's last slot is the current word, so T9FR_MAX_SLOTS - 1 words are enough.
+#define FRAME_HISTORY T9PLUS_CONTEXT_HISTORY
+typedef struct {
+    uint32_t tokens[FRAME_HISTORY];
+    uint8_t punct;        // Bit of the punctuation right before the current word, 0 for none
+    uint8_t register_bit; // T9FR_REGISTER_*, 0 while unknown
+    uint8_t sentence_len; // Words in the sentence before the current one
+    bool is_question;
+} GateContext;
+
+// Result cache: the suggestions of recent lookups by prefix and context, so backspacing,
+// retyping and returning to the T9 screen repeat no search. Lookups compute into a slot and
+// t9plus_get_suggestion_list_ctx() hands out views of it, so a slot's words stay in place
+// until the slot is reused.
+#define RESULT_CACHE_SLOTS 8
+
+typedef struct {
+    char prefix[MAX_WORD_LEN];  // Lowercase prefix, empty for next-word predictions
+    char prev[T9BG_WORD_SIZE];  // Bigram key of the previous word for next-word predictions
+    GateContext gate;
+    uint32_t ready; // Bit per lexicon part, then the user dictionary, loaded for the results
+} ResultKey;
+
+// Keys are hashed and compared as bytes, so they must have no padding
+_Static_assert(
+    sizeof(GateContext) == FRAME_HISTORY * sizeof(uint32_t) + 3 * sizeof(uint8_t) + sizeof(bool),
+    "GateContext has padding");
+_Static_assert(
+    sizeof(ResultKey) == MAX_WORD_LEN + T9BG_WORD_SIZE + sizeof(GateContext) + sizeof(uint32_t),
+    "ResultKey has padding");
+
+typedef struct {
+    ResultKey key;
+    uint32_t hash;      // result_key_hash() of the key
+    uint32_t last_used; // Cache clock at the last access, 0 if the slot is empty
+    uint32_t generation; // result_generation() of the suggestions
+    uint8_t count;
+    uint8_t lengths[T9PLUS_MAX_SUGGESTIONS];
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH];
+} ResultCacheSlot;
+
+// Typo-tolerant completion: when the exact prefix leaves suggestion slots empty, the trie is
+// searched for prefixes one slip away, i.e. one key replaced by a neighbour on the keyboard or
+// one key pressed twice. Each trie step counts against a budget, which bounds the search.
+#define FUZZY_MIN_PREFIX 2     // Shorter prefixes have too many neighbours to be useful
+#define FUZZY_NEIGHBORS 4      // Left, right, above and below
+#define FUZZY_MAX_VISITS 384   // Trie steps per lookup over both parts
+#define FUZZY_KEY_COUNT 128    // Neighbours are kept for ASCII characters
+
+// User dictionary: words the user typed out or accepted, with learned weights, in a table
+// sorted bytewise by the lowercase word so a prefix is found by binary search, as in the tiers.
+// Each learn appends one "<weight> <word>" line to the log; loading replays it, and compaction
+// rewrites it as one line per word. Learned words rank ahead of the static tiers once their
+// weight reaches USER_MIN_WEIGHT, so a word typed once is not suggested yet.
+#define USER_MAX_WORDS 128
+#define USER_WORD_SIZE 24   // Words of up to 23 characters
+#define USER_MIN_LENGTH 2   // Shorter words gain nothing from completion
+#define USER_MIN_WEIGHT 2
+#define USER_TYPED_WEIGHT 1
+#define USER_ACCEPTED_WEIGHT 2
+#define USER_MAX_WEIGHT 9999
+#define USER_COMPACT_SLACK 64 // Log lines beyond one per word that trigger a compaction
+
+typedef struct {
+    char word[USER_WORD_SIZE]; // Lowercase
+    uint32_t last_used;        // User clock at the last learn, for eviction
+    uint16_t weight;
+    bool capitalized;          // Every learn of the word started with an uppercase letter
+} UserWord;
+
+// Position in the trie after some prefix: the node whose edge label holds the
+// prefix's last character, and the prefix length at the end of that label
+typedef struct {
+    uint16_t node; // T9LEX_NONE if no word has the prefix
+    uint8_t end;
+} TriePos;
+
 typedef struct {
-    char** words;
+    const uint16_t* offsets; // Word start offsets relative to words, in sorted word order
+    const uint16_t* ranks;   // Source order, tier mask and T9LEX_RANK_CAPITALIZED flag of each word
+    const uint8_t* scores;   // Score of each word, see word_score()
+    const char* words;       // Packed NUL-terminated words
     size_t count;
-    size_t capacity;
 } WordTier;
 
+// One independently loaded group of tiers with its own prefix trie
+typedef struct {
+    const T9LexNode* nodes; // Prefix trie over the part's tiers, root first; NULL until loaded
+    size_t node_count;
+    const uint32_t* keys;   // Ordering key of each entry ref, see entry_key()
+    uint16_t tier_base[T9LEX_TIER_COUNT]; // First entry ref of each tier within the part
+    size_t entry_count;
+    uint8_t* arena;  // Single allocation backing the part's tiers and trie, kept across packs
+    size_t arena_size;
+    size_t arena_capacity; // Bytes allocated for the arena, see lexicon_arena()
+    bool ready; // Set by the loader thread once the part can be searched, see part_is_ready()
+} LexiconPart;
+
 static struct {
     WordTier tier1;  // Function words
     WordTier tier2;  // Common lemmas
     WordTier tier3a; // Chat/internet slang
     WordTier tier3b; // Fillers
     WordTier tier4;  // Formal discourse
+    LexiconPart parts[T9LEX_PART_COUNT];
+    // Warm-start snapshot of the parts built from the text tiers, see T9SnapHeader
+    T9SnapStamp snapshot_stamp; // Sources of the default pack, taken before its first text part
+    bool snapshot_stamped;      // snapshot_stamp is taken and every source exists
+    uint8_t snapshot_parts;     // Bit per part built from the text or restored from the snapshot
+    bool snapshot_stale;        // A part was rebuilt, so the snapshot needs rewriting on exit
+    // Bigram table, opened on the app thread by the first next-word lookup
+    File* bigram_file;
+    uint32_t bigram_records;
+    bool bigram_checked; // Opening was attempted
+    // Result of the last next-word lookup, so repeating it needs no SD access
+    bool bigram_cached;
+    char bigram_key[T9BG_WORD_SIZE];
+    char bigram_next[T9BG_NEXT_COUNT][T9BG_WORD_SIZE];
+    uint8_t bigram_next_count;
+    // Frame tables, loaded by the loader thread before the primary part; the words' best entry
+    // ref in each part is resolved before that part is published
+    const T9FrameGate* frame_gates;
+    const T9Frame* frames;
+    const T9FrameWord* frame_words;
+    uint16_t* frame_refs[T9LEX_PART_COUNT];
+    size_t frame_gate_count;
+    size_t frame_count;
+    size_t frame_word_count;
+    uint32_t frame_question_sets; // Sets opening a question gate, see t9plus_context_push_char()
+    uint8_t frame_max_sentence_len; // Longest sentence length any gate tests, see t9plus_context_rebuild()
+    uint8_t* frame_arena;  // Single allocation backing the tables and the refs
+    // Dictionary, opened on the app thread by the first lookup that needs it; the index and
+    // the block cache share one allocation
+    File* dict_file;
+    bool dict_checked; // Opening was attempted
+    uint16_t* dict_index;
+    DictCacheSlot* dict_cache;
+    uint16_t dict_tops_block;
+    uint16_t dict_words_block;
+    uint32_t dict_clock;
+    ResultCacheSlot result_cache[RESULT_CACHE_SLOTS];
+    uint32_t result_clock;
+    const ResultCacheSlot* result_listed; // Slot of the last list handed out, see result_cache_victim()
+    // User dictionary, loaded by the loader thread and then only used on the app thread
+    UserWord* user_words;   // USER_MAX_WORDS slots, the first user_count in use
+    size_t user_count;
+    size_t user_log_lines;  // Lines in the log, one per learn since the last compaction
+    uint32_t user_clock;
+    bool user_ready;        // Set by the loader thread once the table can be used
+    // Neighbours of each key on the keyboard, lowercase, '\0' for unused; set by the app
+    char key_neighbors[FUZZY_KEY_COUNT][FUZZY_NEIGHBORS];
+#if T9PLUS_STATS
+    T9PlusStats stats;
+    size_t stats_heap_before; // Free heap when init started
+#endif
     bool initialized;
+    uint8_t language;      // Language pack loaded, index into language_packs
+    FuriThread* loader;    // Background loader, joined by t9plus_deinit() or a pack switch
+    uint8_t tiers_loaded;  // Tiers read by the loader so far, for t9plus_get_load_progress()
+    bool load_done;        // Loader finished; the error message is final
+    T9PlusLoadCallback load_callback;  // Told about load progress, on the loader thread
+    void* load_context;
+    int failed_count;      // Tier files that could not be loaded
     bool has_load_errors;  // Track if any files failed to load
     char error_message[64];  // Store error message for display
 } t9plus_state = {0};
 
-// Helper: Allocate word tier
-static bool tier_alloc(WordTier* tier, size_t capacity) {
-    tier->words = malloc(capacity * sizeof(char*));
-    if(!tier->words) return false;
-    tier->capacity = capacity;
-    tier->count = 0;
+// Tiers in compiled lexicon order
+static WordTier* const lexicon_tiers[T9LEX_TIER_COUNT] = {
+    &t9plus_state.tier1,
+    &t9plus_state.tier2,
+    &t9plus_state.tier3a,
+    &t9plus_state.tier3b,
+    &t9plus_state.tier4,
+};
+
+// Plain-text sources of each tier, in compiled lexicon order
+static const char* const tier_files[T9LEX_TIER_COUNT] = {
+    T9PLUS_DATA_DIR "/tier1_function_words.txt",
+    T9PLUS_DATA_DIR "/tier2_lemma_list.txt",
+    T9PLUS_DATA_DIR "/tier3a_chat.txt",
+    T9PLUS_DATA_DIR "/tier3b_fillers.txt",
+    T9PLUS_DATA_DIR "/tier4_formal_discourse.txt",
+};
+
+// Language packs. Each pack's files are those of the default pack with its suffix inserted
+// before the extension, e.g. lexicon_de.t9l; the bigram, frame and dictionary files are
+// optional. Only the default pack falls back to the plain-text tier files.
+typedef struct {
+    const char* name;   // Short name shown by the app
+    const char* suffix;
+} LanguagePack;
+
+static const LanguagePack language_packs[] = {
+    {.name = "en", .suffix = ""},
+    {.name = "de", .suffix = "_de"},
+};
+
+#define LANGUAGE_COUNT (sizeof(language_packs) / sizeof(language_packs[0]))
+#define LANGUAGE_DEFAULT 0
+
+// Search priority of each tier, in compiled lexicon order: tier1, tier3a, tier3b, tier2, tier4
+static const uint8_t tier_priority[T9LEX_TIER_COUNT] = {0, 3, 1, 2, 4};
+
+// Lexicon part of each tier, in compiled lexicon order
+static const uint8_t tier_part[T9LEX_TIER_COUNT] = {
+    LEXICON_PRIMARY,
+    LEXICON_DEFERRED,
+    LEXICON_PRIMARY,
+    LEXICON_PRIMARY,
+    LEXICON_DEFERRED,
+};
+
+// TEMPORARY: Hardcoded test words used when tier1 could not be loaded
+static const char* const fallback_words[] = {
+    "the", "that", "this", "to", "it", "is", "in", "and", "have",
+    "we", "were", "will", "would", "hello", "help", "world", "work",
+};
+
+// ============================================================================
+// STATISTICS (T9PLUS_STATS builds only)
+// ============================================================================
+
+// Update a statistics field; compiled to nothing when statistics are disabled
+#if T9PLUS_STATS
+#define STATS_ADD(field, value) (t9plus_state.stats.field += (value))
+#define STATS_SET(field, value) (t9plus_state.stats.field = (value))
+#else
+#define STATS_ADD(field, value) ((void)(value))
+#define STATS_SET(field, value) ((void)(value))
+#endif
+
+// Helper: Read the cycle counter, 0 when statistics are disabled
+static inline uint32_t stats_cycles(void) {
+#if T9PLUS_STATS
+    return DWT->CYCCNT;
+#else
+    return 0;
+#endif
+}
+
+// Helper: Microseconds elapsed since a stats_cycles() reading
+static inline uint32_t stats_elapsed_us(uint32_t start) {
+#if T9PLUS_STATS
+    return (DWT->CYCCNT - start) / furi_hal_cortex_instructions_per_microsecond();
+#else
+    UNUSED(start);
+    return 0;
+#endif
+}
+
+// Helper: Track the lowest free heap seen while the lexicon is built
+static inline void stats_sample_heap(void) {
+#if T9PLUS_STATS
+    size_t free_heap = memmgr_get_free_heap();
+    if(free_heap < t9plus_state.stats_heap_before &&
+       t9plus_state.stats_heap_before - free_heap > t9plus_state.stats.heap_peak) {
+        t9plus_state.stats.heap_peak = t9plus_state.stats_heap_before - free_heap;
+    }
+#endif
+}
+
+// Helper: Account one suggestion lookup started at a stats_cycles() reading
+static inline void stats_record_lookup(uint32_t start) {
+#if T9PLUS_STATS
+    uint32_t cycles = DWT->CYCCNT - start;
+    T9PlusStats* stats = &t9plus_state.stats;
+    if(stats->lookups == 0 || cycles < stats->lookup_cycles_min) stats->lookup_cycles_min = cycles;
+    if(cycles > stats->lookup_cycles_max) stats->lookup_cycles_max = cycles;
+    stats->lookup_cycles_total += cycles;
+    stats->lookups++;
+#else
+    UNUSED(start);
+#endif
+}
+
+// ============================================================================
+// LOADER THREAD HANDOFF
+// ============================================================================
+
+// The loader thread fills a part completely before setting its flag, and lookups on the
+// app thread only touch parts whose flag they have seen set. The release/acquire pair
+// orders the part's contents before the flag.
+
+// Helper: Set a flag written by the loader thread
+static inline void loader_publish(bool* flag) {
+    __atomic_store_n(flag, true, __ATOMIC_RELEASE);
+}
+
+// Helper: Read a flag written by the loader thread
+static inline bool loader_published(const bool* flag) {
+    return __atomic_load_n(flag, __ATOMIC_ACQUIRE);
+}
+
+// Helper: Check whether a part may be searched
+static inline bool part_is_ready(const LexiconPart* part) {
+    return loader_published(&part->ready);
+}
+
+// Helper: Tell the app the load progress or readiness may have changed
+static inline void loader_notify(void) {
+    if(t9plus_state.load_callback) t9plus_state.load_callback(t9plus_state.load_context);
+}
+
+// Helper: Account tiers read by the loader for the progress value
+static inline void load_progress_add(uint8_t tiers) {
+    __atomic_add_fetch(&t9plus_state.tiers_loaded, tiers, __ATOMIC_RELAXED);
+    loader_notify();
+}
+
+// Helper: Get word at index from tier
+static inline const char* tier_word(const WordTier* tier, size_t index) {
+    return tier->words + tier->offsets[index];
+}
+
+// Helper: Get the tier number (compiled lexicon order) of an entry ref of a part
+static size_t entry_tier_number(const LexiconPart* part, uint16_t ref) {
+    size_t t = T9LEX_TIER_COUNT - 1;
+    while(ref < part->tier_base[t]) {
+        t--;
+    }
+    return t;
+}
+
+// Helper: Number of words a tier contributes to a part, 0 if it belongs to the other part
+static size_t part_tier_count(const LexiconPart* part, size_t t) {
+    size_t next = t + 1 < T9LEX_TIER_COUNT ? part->tier_base[t + 1] : part->entry_count;
+    return next - part->tier_base[t];
+}
+
+// Helper: Resolve an entry ref of a part to its tier and index within the tier
+static const WordTier* entry_tier(const LexiconPart* part, uint16_t ref, size_t* index) {
+    size_t t = entry_tier_number(part, ref);
+    *index = ref - part->tier_base[t];
+    return lexicon_tiers[t];
+}
+
+// Helper: Get the word of an entry ref of a part
+static const char* entry_word(const LexiconPart* part, uint16_t ref) {
+    size_t index;
+    const WordTier* tier = entry_tier(part, ref, &index);
+    return tier_word(tier, index);
+}
+
+// Helper: Get the arena of a part with room for size bytes. It is only reallocated when it
+// is too small, so the parts of another pack are read into the same memory.
+static uint8_t* lexicon_arena(size_t part_id, size_t size) {
+    LexiconPart* part = &t9plus_state.parts[part_id];
+    if(part->arena_capacity < size) {
+        free(part->arena);
+        part->arena = malloc(size);
+        part->arena_capacity = size;
+        stats_sample_heap();
+    }
+    return part->arena;
+}
+
+// Helper: Forget all tiers and tries, keeping the arenas for the next pack
+static void lexicon_unload(void) {
+    for(size_t p = 0; p < T9LEX_PART_COUNT; p++) {
+        LexiconPart* part = &t9plus_state.parts[p];
+        uint8_t* arena = part->arena;
+        size_t capacity = part->arena_capacity;
+        memset(part, 0, sizeof(LexiconPart));
+        part->arena = arena;
+        part->arena_capacity = capacity;
+    }
+    for(size_t t = 0; t < T9LEX_TIER_COUNT; t++) {
+        memset(lexicon_tiers[t], 0, sizeof(WordTier));
+    }
+    t9plus_state.snapshot_parts = 0;
+    t9plus_state.snapshot_stale = false;
+}
+
+// Helper: Release the arenas backing all tiers and tries
+static void lexicon_free(void) {
+    lexicon_unload();
+    for(size_t p = 0; p < T9LEX_PART_COUNT; p++) {
+        free(t9plus_state.parts[p].arena);
+        t9plus_state.parts[p].arena = NULL;
+        t9plus_state.parts[p].arena_capacity = 0;
+    }
+}
+
+// Helper: Check that every trie node references valid entries and children
+static bool trie_validate(const T9LexNode* nodes, size_t node_count, size_t entry_count) {
+    if(node_count == 0 || node_count > T9LEX_NONE) return false;
+    
+    for(size_t n = 0; n < node_count; n++) {
+        const T9LexNode* node = &nodes[n];
+        if((n > 0 && node->label_ref >= entry_count) ||
+           node->first_child + node->child_count > node_count) {
+            return false;
+        }
+        for(size_t i = 0; i < T9LEX_TOP_COUNT; i++) {
+            if(node->top[i] != T9LEX_NONE && node->top[i] >= entry_count) return false;
+        }
+    }
+    return true;
+}
+
+// Helper: Point a part's tiers into its arena and number their entries
+static void lexicon_bind_tiers(size_t part_id, uint8_t* arena) {
+    LexiconPart* part = &t9plus_state.parts[part_id];
+    const T9LexTierEntry* entries = ((const T9LexTable*)arena)->tiers;
+    size_t base = 0;
+    for(size_t t = 0; t < T9LEX_TIER_COUNT; t++) {
+        part->tier_base[t] = base;
+        if(tier_part[t] != part_id) continue;
+        lexicon_tiers[t]->offsets = (const uint16_t*)(arena + entries[t].index_offset);
+        lexicon_tiers[t]->ranks = (const uint16_t*)(arena + entries[t].ranks_offset);
+        lexicon_tiers[t]->scores = arena + entries[t].scores_offset;
+        lexicon_tiers[t]->words = (const char*)(arena + entries[t].words_offset);
+        lexicon_tiers[t]->count = entries[t].count;
+        base += entries[t].count;
+    }
+    part->entry_count = base;
+}
+
+// Helper: Validate the tables of a part's arena and point its tiers and trie into it
+static bool lexicon_attach(size_t part_id, uint8_t* arena, size_t arena_size) {
+    if(arena_size < sizeof(T9LexTable)) return false;
+    
+    // Every word must be terminated before the keys start
+    const T9LexTable* table = (const T9LexTable*)arena;
+    if(table->keys_offset == 0 || table->keys_offset > table->nodes_offset ||
+       table->nodes_offset > arena_size || arena[table->keys_offset - 1] != '\0') {
+        return false;
+    }
+    
+    const T9LexTierEntry* entries = table->tiers;
+    size_t entry_count = 0;
+    for(size_t t = 0; t < T9LEX_TIER_COUNT; t++) {
+        const T9LexTierEntry* entry = &entries[t];
+        if(tier_part[t] != part_id) {
+            // Tiers of the other part must not contribute entries
+            if(entry->count != 0) return false;
+            continue;
+        }
+        if(entry->index_offset % sizeof(uint16_t) != 0 ||
+           entry->ranks_offset % sizeof(uint16_t) != 0 ||
+           entry->index_offset + entry->count * sizeof(uint16_t) > arena_size ||
+           entry->ranks_offset + entry->count * sizeof(uint16_t) > arena_size ||
+           entry->scores_offset + entry->count > arena_size ||
+           entry->words_offset >= table->keys_offset) {
+            return false;
+        }
+        const uint16_t* offsets = (const uint16_t*)(arena + entry->index_offset);
+        for(uint32_t i = 0; i < entry->count; i++) {
+            if(entry->words_offset + offsets[i] >= table->keys_offset) return false;
+        }
+        entry_count += entry->count;
+    }
+    
+    if(entry_count >= T9LEX_NONE || table->keys_offset % sizeof(uint32_t) != 0 ||
+       table->keys_offset + entry_count * sizeof(uint32_t) > table->nodes_offset ||
+       table->nodes_offset % sizeof(uint16_t) != 0 ||
+       table->nodes_offset + table->node_count * sizeof(T9LexNode) > arena_size ||
+       !trie_validate((const T9LexNode*)(arena + table->nodes_offset), table->node_count, entry_count)) {
+        return false;
+    }
+    
+    LexiconPart* part = &t9plus_state.parts[part_id];
+    lexicon_bind_tiers(part_id, arena);
+    part->keys = (const uint32_t*)(arena + table->keys_offset);
+    part->nodes = (const T9LexNode*)(arena + table->nodes_offset);
+    part->node_count = table->node_count;
+    part->arena = arena;
+    part->arena_size = arena_size;
+    return true;
+}
+
+// Builds one tier while parsing text. With offsets == NULL it only measures the tier; the
+// filling pass is capped by what was measured, so a file that grew in between cannot overrun.
+typedef struct {
+    uint16_t* offsets;
+    uint16_t* ranks;
+    uint8_t* scores; // Filled by tier_builder_score() after sorting
+    char* words;
+    size_t count;
+    size_t bytes;
+    size_t max_count; // Room measured by the first pass, used once offsets is set
+    size_t max_bytes;
+} TierBuilder;
+
+// Helper: Append a word to the tier being built, lowercased and ranked by arrival
+static void tier_builder_add(TierBuilder* builder, const char* word, size_t len) {
+    if(builder->count >= MAX_TIER_WORDS || builder->bytes + len + 1 > UINT16_MAX) return;
+    if(builder->offsets && (builder->count >= builder->max_count || builder->bytes + len + 1 > builder->max_bytes)) {
+        return;
+    }
+    
+    if(builder->offsets) {
+        char* dst = builder->words + builder->bytes;
+        for(size_t i = 0; i <= len; i++) {
+            dst[i] = tolower((unsigned char)word[i]);
+        }
+        builder->offsets[builder->count] = builder->bytes;
+        builder->ranks[builder->count] = builder->count;
+        if(isupper((unsigned char)word[0])) {
+            builder->ranks[builder->count] |= T9LEX_RANK_CAPITALIZED;
+        }
+    }
+    builder->count++;
+    builder->bytes += len + 1;
+}
+
+// Words of the tier being sorted; qsort() has no context argument
+static const char* sort_words;
+
+// Helper: Order packed (rank << 16 | offset) entries by word, then by rank
+static int tier_entry_compare(const void* a, const void* b) {
+    uint32_t ea = *(const uint32_t*)a;
+    uint32_t eb = *(const uint32_t*)b;
+    int cmp = strcmp(sort_words + (ea & 0xFFFF), sort_words + (eb & 0xFFFF));
+    if(cmp != 0) return cmp;
+    return ((ea >> 16) & T9LEX_RANK_MASK) < ((eb >> 16) & T9LEX_RANK_MASK) ? -1 : 1;
+}
+
+// Helper: Sort a built tier's offsets and ranks by word
+static void tier_builder_sort(TierBuilder* builder) {
+    if(builder->count < 2) return;
+    
+    uint32_t* entries = malloc(builder->count * sizeof(uint32_t));
+    for(size_t i = 0; i < builder->count; i++) {
+        entries[i] = ((uint32_t)builder->ranks[i] << 16) | builder->offsets[i];
+    }
+    sort_words = builder->words;
+    qsort(entries, builder->count, sizeof(uint32_t), tier_entry_compare);
+    for(size_t i = 0; i < builder->count; i++) {
+        builder->offsets[i] = entries[i] & 0xFFFF;
+        builder->ranks[i] = entries[i] >> 16;
+    }
+    free(entries);
+}
+
+// Helper: Trim a parsed line and add it unless it is empty or a comment
+static void tier_builder_add_line(char* line, size_t len, void* context) {
+    TierBuilder* builder = context;
+    while(len > 0 && isspace((unsigned char)line[len - 1])) {
+        len--;
+    }
+    line[len] = '\0';
+    if(len > 0 && line[0] != '#') {
+        tier_builder_add(builder, line, len);
+    }
+}
+
+// Helper: Pass each line of a plain-text file to handle(), NUL-terminated and without its line
+// break. Lines longer than MAX_WORD_LEN are skipped. Returns false if the file cannot be opened.
+static bool read_lines(const char* path, void (*handle)(char* line, size_t len, void* context), void* context) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    
+    bool success = false;
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        FURI_LOG_I(TAG, "File opened successfully: %s", path);
+        char* chunk = malloc(READ_CHUNK_SIZE);
+        char line[MAX_WORD_LEN + 1];
+        size_t pos = 0;
+        bool too_long = false; // Current line exceeds MAX_WORD_LEN and is skipped
+        size_t bytes_read;
+        
+        // Read the file in blocks and split lines in memory
+        while((bytes_read = storage_file_read(file, chunk, READ_CHUNK_SIZE)) > 0) {
+            for(size_t i = 0; i < bytes_read; i++) {
+                char c = chunk[i];
+                if(c == '\n' || c == '\r') {
+                    if(!too_long) {
+                        line[pos] = '\0';
+                        handle(line, pos, context);
+                    }
+                    pos = 0;
+                    too_long = false;
+                } else if(too_long) {
+                    continue;
+                } else if(pos < MAX_WORD_LEN) {
+                    line[pos++] = c;
+                } else {
+                    too_long = true;
+                }
+            }
+        }
+        
+        // End of file - process last line if exists
+        if(!too_long) {
+            line[pos] = '\0';
+            handle(line, pos, context);
+        }
+        
+        free(chunk);
+        success = true;
+        storage_file_close(file);
+    }
+    
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    
+    return success;
+}
+
+// Helper: Parse words from a plain-text file, one word per line
+static bool load_tier_from_file(const char* path, TierBuilder* builder) {
+    FURI_LOG_I(TAG, "Loading tier from: %s", path);
+    
+    if(!read_lines(path, tier_builder_add_line, builder)) {
+        FURI_LOG_E(TAG, "Failed to open file: %s", path);
+        return false;
+    }
+    FURI_LOG_I(TAG, "Loaded %zu words from %s", builder->count, path);
+    return true;
+}
+
+// Helper: Fill the tier builders of a part from the text files, returns number of missing files
+static int load_tiers_from_text(size_t part_id, TierBuilder builders[T9LEX_TIER_COUNT]) {
+    int failed_count = 0;
+    for(size_t t = 0; t < T9LEX_TIER_COUNT; t++) {
+        if(tier_part[t] != part_id) continue;
+        uint32_t start = stats_cycles();
+        if(!load_tier_from_file(tier_files[t], &builders[t])) {
+            failed_count++;
+        }
+        // The first pass only measures; the tier counts as loaded once it has been filled
+        if(builders[t].offsets) load_progress_add(1);
+        STATS_ADD(tier_load_us[t], stats_elapsed_us(start));
+    }
+    
+    if(part_id == LEXICON_PRIMARY && builders[0].count == 0) {
+        FURI_LOG_W(TAG, "Tier1 empty, adding hardcoded test words");
+        for(size_t i = 0; i < COUNT_OF(fallback_words); i++) {
+            tier_builder_add(&builders[0], fallback_words[i], strlen(fallback_words[i]));
+        }
+    }
+    return failed_count;
+}
+
+// Helper: Parse the unigram list into a sorted word list for scoring, false if it is missing.
+// The list is only needed while the text tiers are indexed; release it with unigram_free().
+static bool unigram_load(TierBuilder* unigram) {
+    *unigram = (TierBuilder){0};
+    if(!load_tier_from_file(T9PLUS_UNIGRAM_PATH, unigram) || unigram->count == 0) return false;
+    
+    size_t count = unigram->count;
+    uint16_t* block = malloc(2 * count * sizeof(uint16_t) + unigram->bytes);
+    stats_sample_heap();
+    *unigram = (TierBuilder){
+        .offsets = block,
+        .ranks = block + count,
+        .words = (char*)(block + 2 * count),
+        .max_count = count,
+        .max_bytes = unigram->bytes,
+    };
+    load_tier_from_file(T9PLUS_UNIGRAM_PATH, unigram);
+    tier_builder_sort(unigram);
     return true;
 }
 
-// Helper: Free word tier
-static void tier_free(WordTier* tier) {
-    if(tier->words) {
-        for(size_t i = 0; i < tier->count; i++) {
-            free(tier->words[i]);
-        }
-        free(tier->words);
-        tier->words = NULL;
+// Helper: Release a word list parsed by unigram_load()
+static void unigram_free(TierBuilder* unigram) {
+    free(unigram->offsets);
+    *unigram = (TierBuilder){0};
+}
+
+// Helper: Position of a lowercase word in the unigram list, MAX_TIER_WORDS if it is not listed
+static size_t unigram_position(const TierBuilder* unigram, const char* word) {
+    // Lower bound: the first of several equal words has the lowest position
+    size_t lo = 0;
+    size_t hi = unigram->count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(strcmp(unigram->words + unigram->offsets[mid], word) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if(lo < unigram->count && strcmp(unigram->words + unigram->offsets[lo], word) == 0) {
+        return unigram->ranks[lo] & T9LEX_RANK_MASK;
+    }
+    return MAX_TIER_WORDS;
+}
+
+// Helper: One-byte score of a word from its unigram position and its tier, lower is better
+static uint8_t word_score(size_t unigram_position, size_t tier) {
+    size_t score = unigram_position < MAX_TIER_WORDS ? unigram_position / SCORE_UNIGRAM_STEP : SCORE_UNKNOWN;
+    score += tier_priority[tier] * SCORE_TIER_STEP;
+    return score < UINT8_MAX ? score : UINT8_MAX;
+}
+
+// Helper: Score every word of a sorted tier; unigram may be empty
+static void tier_builder_score(TierBuilder* builder, size_t tier, const TierBuilder* unigram) {
+    for(size_t i = 0; i < builder->count; i++) {
+        const char* word = builder->words + builder->offsets[i];
+        builder->scores[i] = word_score(unigram_position(unigram, word), tier);
+    }
+}
+
+// Helper: Fill the ordering keys of a part's entry refs from its bound tiers: score, then tier
+// priority, then rank within the tier, as tools/build_lexicon.py does
+static void entry_keys_fill(const LexiconPart* part, uint32_t* keys) {
+    for(size_t t = 0; t < T9LEX_TIER_COUNT; t++) {
+        const WordTier* tier = lexicon_tiers[t];
+        size_t count = part_tier_count(part, t);
+        for(size_t i = 0; i < count; i++) {
+            keys[part->tier_base[t] + i] = ((uint32_t)tier->scores[i] << 24) |
+                                           ((uint32_t)tier_priority[t] << 16) |
+                                           (tier->ranks[i] & T9LEX_RANK_MASK);
+        }
+    }
+}
+
+// Helper: Ordering key of an entry ref of a part, lower ranks first. Keys of a part are one
+// packed table, so ranking candidates needs neither their tier nor their word.
+static inline uint32_t entry_key(const LexiconPart* part, uint16_t ref) {
+    return part->keys[ref];
+}
+
+// Helper: Compare the first len bytes of a stored lowercase word with a lowercase prefix, four
+// bytes at a time, with the sign of strncmp(). The prefix holds no NUL in its first len bytes,
+// so a shorter word differs at its NUL and nothing past it decides the result; len may exceed
+// the word's length but not the size of the field holding it.
+static inline int prefix_compare(const char* word, const char* prefix, size_t len) {
+    size_t i = 0;
+    for(; i + sizeof(uint32_t) <= len; i += sizeof(uint32_t)) {
+        uint32_t a;
+        uint32_t b;
+        memcpy(&a, word + i, sizeof(a));
+        memcpy(&b, prefix + i, sizeof(b));
+        if(a != b) {
+            // Little-endian loads: the lowest set bit of the difference is in the first differing byte
+            i += __builtin_ctz(a ^ b) / 8;
+            return (uint8_t)word[i] - (uint8_t)prefix[i];
+        }
+    }
+    for(; i < len; i++) {
+        if(word[i] != prefix[i]) return (uint8_t)word[i] - (uint8_t)prefix[i];
+    }
+    return 0;
+}
+
+// Helper: Binary search a sorted tier for a lowercase word, returns its index or tier->count
+static size_t tier_find(const WordTier* tier, const char* word) {
+    size_t lo = 0;
+    size_t hi = tier->count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(tier_word(tier, mid), word);
+        if(cmp == 0) return mid;
+        if(cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return tier->count;
+}
+
+// Helper: Find a word in the tiers of better priority than tier t and record tier t in the
+// mask of its entry there, false if none of them lists it. Tiers of the part being built are
+// searched in their sorted builders; the tiers of the other part, all of better priority when
+// the deferred part is built, are loaded already and only searched.
+static bool tier_builders_claim(
+    size_t part_id,
+    TierBuilder builders[T9LEX_TIER_COUNT],
+    size_t t,
+    const char* word
+) {
+    for(size_t other = 0; other < T9LEX_TIER_COUNT; other++) {
+        if(tier_priority[other] >= tier_priority[t]) continue;
+        if(tier_part[other] != part_id) {
+            if(tier_find(lexicon_tiers[other], word) < lexicon_tiers[other]->count) return true;
+            continue;
+        }
+        TierBuilder* builder = &builders[other];
+        WordTier view = {
+            .offsets = builder->offsets,
+            .ranks = builder->ranks,
+            .words = builder->words,
+            .count = builder->count,
+        };
+        size_t index = tier_find(&view, word);
+        if(index < builder->count) {
+            builder->ranks[index] |= 1 << (T9LEX_RANK_TIERS_SHIFT + t);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Helper: Keep each word of the sorted tiers of a part once, in the listing tier of best
+// priority, as tools/build_lexicon.py does. Tiers are deduplicated best first, so every tier
+// searched for a word is final. The loaded primary part cannot be changed, so the masks of its
+// words leave out the deferred tiers listing them.
+static void tier_builders_dedupe(size_t part_id, TierBuilder builders[T9LEX_TIER_COUNT]) {
+    for(uint8_t priority = 0; priority < T9LEX_TIER_COUNT; priority++) {
+        size_t t = 0;
+        while(tier_priority[t] != priority) {
+            t++;
+        }
+        if(tier_part[t] != part_id) continue;
+        
+        // Repeats of a word within its tier sort right after its entry of best rank
+        TierBuilder* builder = &builders[t];
+        size_t kept = 0;
+        for(size_t i = 0; i < builder->count; i++) {
+            const char* word = builder->words + builder->offsets[i];
+            if(kept > 0 && strcmp(builder->words + builder->offsets[kept - 1], word) == 0) continue;
+            if(tier_builders_claim(part_id, builders, t, word)) continue;
+            builder->offsets[kept] = builder->offsets[i];
+            builder->ranks[kept] = builder->ranks[i] | 1 << (T9LEX_RANK_TIERS_SHIFT + t);
+            kept++;
+        }
+        builder->count = kept;
+    }
+}
+
+// Helper: Merge the sorted tiers of a part into one list of entry refs ordered by word, then key
+static void trie_merge_entries(const LexiconPart* part, uint16_t* refs) {
+    size_t heads[T9LEX_TIER_COUNT] = {0};
+    for(size_t n = 0; n < part->entry_count; n++) {
+        size_t best = T9LEX_TIER_COUNT;
+        for(size_t t = 0; t < T9LEX_TIER_COUNT; t++) {
+            if(heads[t] >= part_tier_count(part, t)) continue;
+            if(best == T9LEX_TIER_COUNT) {
+                best = t;
+                continue;
+            }
+            int cmp = strcmp(
+                tier_word(lexicon_tiers[t], heads[t]), tier_word(lexicon_tiers[best], heads[best]));
+            if(cmp < 0 || (cmp == 0 && tier_priority[t] < tier_priority[best])) {
+                best = t;
+            }
+        }
+        refs[n] = part->tier_base[best] + heads[best];
+        heads[best]++;
+    }
+}
+
+// Bounded top-K list of candidates by entry_key(), best first. It lives on the stack and
+// inserting is O(K), so building and lookups never allocate for it.
+typedef struct {
+    uint32_t keys[T9LEX_TOP_COUNT];
+    uint16_t refs[T9LEX_TOP_COUNT];
+    const LexiconPart* parts[T9LEX_TOP_COUNT];
+    uint8_t count;
+} TopK;
+
+// Helper: Offer an entry ref of a part with its ordering key to a top-K list, false if it
+// ranks below all K. An entry already listed keeps the better of its two keys.
+static bool topk_insert_key(TopK* top, const LexiconPart* part, uint16_t ref, uint32_t key) {
+    for(uint8_t i = 0; i < top->count; i++) {
+        if(top->refs[i] != ref || top->parts[i] != part) continue;
+        if(top->keys[i] <= key) return true;
+        top->count--;
+        for(uint8_t j = i; j < top->count; j++) {
+            top->keys[j] = top->keys[j + 1];
+            top->refs[j] = top->refs[j + 1];
+            top->parts[j] = top->parts[j + 1];
+        }
+        break;
+    }
+    
+    uint8_t slot = top->count;
+    while(slot > 0 && top->keys[slot - 1] > key) {
+        slot--;
+    }
+    if(slot >= T9LEX_TOP_COUNT) return false;
+    
+    if(top->count < T9LEX_TOP_COUNT) top->count++;
+    for(uint8_t j = top->count - 1; j > slot; j--) {
+        top->keys[j] = top->keys[j - 1];
+        top->refs[j] = top->refs[j - 1];
+        top->parts[j] = top->parts[j - 1];
+    }
+    top->keys[slot] = key;
+    top->refs[slot] = ref;
+    top->parts[slot] = part;
+    return true;
+}
+
+// Helper: Offer an entry ref of a part to a top-K list by its own key
+static bool topk_insert(TopK* top, const LexiconPart* part, uint16_t ref) {
+    return topk_insert_key(top, part, ref, entry_key(part, ref));
+}
+
+// Helper: Cache the best ranked entries of refs[lo, hi) in a node
+static void trie_fill_top(
+    const LexiconPart* part,
+    T9LexNode* node,
+    const uint16_t* refs,
+    size_t lo,
+    size_t hi
+) {
+    TopK top = {0};
+    for(size_t i = lo; i < hi; i++) {
+        topk_insert(&top, part, refs[i]);
+    }
+    for(size_t i = 0; i < T9LEX_TOP_COUNT; i++) {
+        node->top[i] = i < top.count ? top.refs[i] : T9LEX_NONE;
+    }
+}
+
+// Trie node under construction: entries refs[lo, hi) share the node's prefix
+typedef struct {
+    uint16_t lo;
+    uint16_t hi;
+    uint8_t depth; // Prefix length at the end of the node's label
+} TrieRange;
+
+// Helper: Build the path-compressed trie of a part breadth first, so siblings are contiguous.
+// nodes must hold 2 * entry_count + 1 nodes, the upper bound for this trie. Returns node count.
+static size_t trie_build(const LexiconPart* part, T9LexNode* nodes) {
+    size_t entry_count = part->entry_count;
+    uint16_t* refs = malloc((entry_count + 1) * sizeof(uint16_t));
+    TrieRange* ranges = malloc((2 * entry_count + 1) * sizeof(TrieRange));
+    stats_sample_heap();
+    trie_merge_entries(part, refs);
+    
+    memset(&nodes[0], 0, sizeof(T9LexNode));
+    ranges[0] = (TrieRange){.lo = 0, .hi = entry_count, .depth = 0};
+    size_t node_count = 1;
+    
+    for(size_t n = 0; n < node_count; n++) {
+        TrieRange range = ranges[n];
+        T9LexNode* node = &nodes[n];
+        trie_fill_top(part, node, refs, range.lo, range.hi);
+        node->first_child = node_count;
+        node->child_count = 0;
+        
+        // Words ending at this node sort first, the rest is grouped by next character
+        size_t i = range.lo;
+        while(i < range.hi && entry_word(part, refs[i])[range.depth] == '\0') {
+            i++;
+        }
+        while(i < range.hi) {
+            const char* first = entry_word(part, refs[i]);
+            size_t j = i + 1;
+            while(j < range.hi && entry_word(part, refs[j])[range.depth] == first[range.depth]) {
+                j++;
+            }
+            
+            // The group's common prefix is the common prefix of its first and last word
+            const char* last = entry_word(part, refs[j - 1]);
+            size_t depth = range.depth + 1;
+            while(first[depth] != '\0' && first[depth] == last[depth]) {
+                depth++;
+            }
+            
+            nodes[node_count] = (T9LexNode){
+                .label_ref = refs[i],
+                .label_len = depth - range.depth,
+            };
+            ranges[node_count] = (TrieRange){.lo = i, .hi = j, .depth = depth};
+            node_count++;
+            node->child_count++;
+            i = j;
+        }
+    }
+    
+    free(ranges);
+    free(refs);
+    return node_count;
+}
+
+// Helper: Build a part's arena from its plain-text tier files.
+// The files are parsed twice: once to size the arena exactly, once to fill it.
+// The trie is built into space reserved for its upper bound. Only the nodes built count toward
+// the part's size; the arena keeps its capacity, so other packs are still read into it.
+static int build_lexicon_from_text(size_t part_id) {
+    TierBuilder builders[T9LEX_TIER_COUNT] = {0};
+    int failed_count = load_tiers_from_text(part_id, builders);
+    
+    // Lay out the tables, then each tier's offsets, ranks and scores followed by its words
+    T9LexTable table;
+    size_t arena_size = sizeof(table);
+    size_t entry_count = 0;
+    for(size_t t = 0; t < T9LEX_TIER_COUNT; t++) {
+        arena_size += arena_size % sizeof(uint16_t);
+        table.tiers[t].index_offset = arena_size;
+        table.tiers[t].count = builders[t].count;
+        arena_size += builders[t].count * sizeof(uint16_t);
+        table.tiers[t].ranks_offset = arena_size;
+        arena_size += builders[t].count * sizeof(uint16_t);
+        table.tiers[t].scores_offset = arena_size;
+        arena_size += builders[t].count;
+        table.tiers[t].words_offset = arena_size;
+        arena_size += builders[t].bytes;
+        entry_count += builders[t].count;
+    }
+    // Terminate the word data even if every tier is empty, then align the keys. Keys are
+    // reserved for every parsed word, duplicates included.
+    size_t words_end = arena_size;
+    arena_size++;
+    arena_size += (sizeof(uint32_t) - arena_size % sizeof(uint32_t)) % sizeof(uint32_t);
+    table.keys_offset = arena_size;
+    arena_size += entry_count * sizeof(uint32_t);
+    table.nodes_offset = arena_size;
+    arena_size += (2 * entry_count + 1) * sizeof(T9LexNode);
+    
+    uint8_t* arena = lexicon_arena(part_id, arena_size);
+    memset(arena + words_end, 0, table.keys_offset - words_end);
+    for(size_t t = 0; t < T9LEX_TIER_COUNT; t++) {
+        builders[t] = (TierBuilder){
+            .offsets = (uint16_t*)(arena + table.tiers[t].index_offset),
+            .ranks = (uint16_t*)(arena + table.tiers[t].ranks_offset),
+            .scores = arena + table.tiers[t].scores_offset,
+            .words = (char*)(arena + table.tiers[t].words_offset),
+            .max_count = builders[t].count,
+            .max_bytes = builders[t].bytes,
+        };
+    }
+    load_tiers_from_text(part_id, builders);
+    
+    TierBuilder unigram;
+    if(!unigram_load(&unigram)) {
+        FURI_LOG_W(TAG, "No unigram list, ranking by tier only");
+    }
+    for(size_t t = 0; t < T9LEX_TIER_COUNT; t++) {
+        tier_builder_sort(&builders[t]);
+    }
+    tier_builders_dedupe(part_id, builders);
+    for(size_t t = 0; t < T9LEX_TIER_COUNT; t++) {
+        tier_builder_score(&builders[t], t, &unigram);
+        table.tiers[t].count = builders[t].count;
+    }
+    unigram_free(&unigram);
+    
+    // The words of dropped duplicates stay behind in the word data, unreferenced
+    LexiconPart* part = &t9plus_state.parts[part_id];
+    memcpy(arena, &table, sizeof(table));
+    lexicon_bind_tiers(part_id, arena);
+    entry_keys_fill(part, (uint32_t*)(arena + table.keys_offset));
+    part->keys = (const uint32_t*)(arena + table.keys_offset);
+    uint32_t start = stats_cycles();
+    table.node_count = trie_build(part, (T9LexNode*)(arena + table.nodes_offset));
+    STATS_ADD(trie_build_us, stats_elapsed_us(start));
+    memcpy(arena, &table, sizeof(table));
+    
+    arena_size = table.nodes_offset + table.node_count * sizeof(T9LexNode);
+    furi_check(lexicon_attach(part_id, arena, arena_size));
+    FURI_LOG_I(TAG, "Built trie: %zu nodes for %zu entries", part->node_count, part->entry_count);
+    return failed_count;
+}
+
+// Helper: Read the header of an opened compiled lexicon, false if it is not supported
+static bool read_lexicon_header(File* file, T9LexHeader* header) {
+    return storage_file_read(file, header, sizeof(*header)) == sizeof(*header) &&
+           header->magic == T9LEX_MAGIC && header->version == T9LEX_VERSION &&
+           header->tier_count == T9LEX_TIER_COUNT;
+}
+
+// Helper: Read the header of a language pack's compiled lexicon, false if it has none
+static bool lexicon_pack_header(uint8_t language, T9LexHeader* header) {
+    char path[PACK_PATH_SIZE];
+    PACK_PATH(path, T9PLUS_LEXICON_FILE, language);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool found = storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+                 read_lexicon_header(file, header);
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return found;
+}
+
+// Helper: Grow the arenas to the largest part of any installed pack, so switching packs
+// reads into them without allocating. A header read per pack is all it costs.
+static void lexicon_reserve(void) {
+    for(uint8_t l = 0; l < LANGUAGE_COUNT; l++) {
+        T9LexHeader header;
+        if(!lexicon_pack_header(l, &header)) continue;
+        for(size_t p = 0; p < T9LEX_PART_COUNT; p++) {
+            lexicon_arena(p, header.arena_size[p]);
+        }
+    }
+}
+
+// Helper: FNV-1a hash of an arena as read, matched against the checksum in the header
+static uint32_t lexicon_checksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261UL;
+    for(size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+// Helper: Read the header and one part's arena of an opened compiled lexicon, which starts
+// base bytes into the file; the file is positioned at its header
+static bool read_lexicon(File* file, size_t base, size_t part_id) {
+    T9LexHeader header;
+    
+    if(!read_lexicon_header(file, &header)) {
+        FURI_LOG_W(TAG, "Compiled lexicon has unsupported header");
+        return false;
+    }
+    
+    // Parts follow the header back to back
+    uint64_t offset = base + sizeof(header);
+    for(size_t p = 0; p < part_id; p++) {
+        offset += header.arena_size[p];
+    }
+    size_t arena_size = header.arena_size[part_id];
+    if(arena_size == 0 || offset + arena_size > storage_file_size(file) ||
+       !storage_file_seek(file, offset, true)) {
+        FURI_LOG_W(TAG, "Compiled lexicon truncated");
+        return false;
+    }
+    
+    // The arena is kept on failure; the text fallback or the next pack reuses it
+    uint8_t* arena = lexicon_arena(part_id, arena_size);
+    if(storage_file_read(file, arena, arena_size) != arena_size) {
+        FURI_LOG_W(TAG, "Compiled lexicon truncated");
+    } else if(lexicon_checksum(arena, arena_size) != header.checksum[part_id]) {
+        FURI_LOG_W(TAG, "Compiled lexicon checksum mismatch");
+    } else if(!lexicon_attach(part_id, arena, arena_size)) {
+        FURI_LOG_W(TAG, "Compiled lexicon corrupt");
+    } else {
+        return true;
+    }
+    return false;
+}
+
+// Helper: Load one part's tiers from the compiled lexicon with two block reads
+static bool load_lexicon(const char* path, size_t part_id) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    
+    bool success = false;
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        success = read_lexicon(file, 0, part_id);
+        storage_file_close(file);
+    } else {
+        FURI_LOG_I(TAG, "No compiled lexicon at %s", path);
+    }
+    
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    
+    if(success) {
+        FURI_LOG_I(TAG, "Loaded compiled lexicon part %zu: %s", part_id, path);
+    }
+    return success;
+}
+
+// Helper: Take the stamp of the default pack's text sources once, false if any is missing.
+// A part built from missing files is not worth keeping.
+static bool snapshot_stamp_sources(void) {
+    if(t9plus_state.snapshot_stamped) return true;
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    T9SnapStamp* stamp = &t9plus_state.snapshot_stamp;
+    bool stamped = true;
+    for(size_t i = 0; i < T9SNAP_SOURCE_COUNT && stamped; i++) {
+        const char* path = i < T9LEX_TIER_COUNT ? tier_files[i] : T9PLUS_UNIGRAM_PATH;
+        FileInfo info;
+        stamped = storage_common_stat(storage, path, &info) == FSE_OK &&
+                  storage_common_timestamp(storage, path, &stamp->timestamp[i]) == FSE_OK;
+        stamp->size[i] = stamped ? info.size : 0;
+    }
+    furi_record_close(RECORD_STORAGE);
+    
+    t9plus_state.snapshot_stamped = stamped;
+    return stamped;
+}
+
+// Helper: Restore one part of the default pack from the snapshot, false if it is missing,
+// out of date or damaged
+static bool snapshot_load(size_t part_id) {
+    if(!snapshot_stamp_sources()) return false;
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    
+    bool success = false;
+    if(storage_file_open(file, T9PLUS_SNAPSHOT_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        T9SnapHeader snap;
+        if(storage_file_read(file, &snap, sizeof(snap)) != sizeof(snap) ||
+           snap.magic != T9SNAP_MAGIC || snap.version != T9SNAP_VERSION ||
+           snap.source_count != T9SNAP_SOURCE_COUNT) {
+            FURI_LOG_W(TAG, "Snapshot has unsupported header");
+        } else if(memcmp(&snap.sources, &t9plus_state.snapshot_stamp, sizeof(T9SnapStamp)) != 0) {
+            FURI_LOG_I(TAG, "Snapshot is out of date, rebuilding");
+        } else {
+            success = read_lexicon(file, sizeof(snap), part_id);
+        }
+        storage_file_close(file);
+    }
+    
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    
+    if(success) {
+        FURI_LOG_I(TAG, "Restored lexicon part %zu from snapshot", part_id);
+    }
+    return success;
+}
+
+// Helper: Write both parts of the default pack to the snapshot if one of them was rebuilt.
+// The snapshot is written next to the old one and renamed over it, as the user log is.
+static void snapshot_save(void) {
+    if(!t9plus_state.snapshot_stale || !t9plus_state.snapshot_stamped ||
+       t9plus_state.snapshot_parts != (1 << T9LEX_PART_COUNT) - 1) {
+        return;
+    }
+    
+    T9SnapHeader snap = {
+        .magic = T9SNAP_MAGIC,
+        .version = T9SNAP_VERSION,
+        .source_count = T9SNAP_SOURCE_COUNT,
+        .sources = t9plus_state.snapshot_stamp,
+    };
+    T9LexHeader header = {
+        .magic = T9LEX_MAGIC,
+        .version = T9LEX_VERSION,
+        .tier_count = T9LEX_TIER_COUNT,
+    };
+    for(size_t p = 0; p < T9LEX_PART_COUNT; p++) {
+        const LexiconPart* part = &t9plus_state.parts[p];
+        header.arena_size[p] = part->arena_size;
+        header.checksum[p] = lexicon_checksum(part->arena, part->arena_size);
+    }
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool written = storage_file_open(file, T9PLUS_SNAPSHOT_TEMP_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+                   storage_file_write(file, &snap, sizeof(snap)) == sizeof(snap) &&
+                   storage_file_write(file, &header, sizeof(header)) == sizeof(header);
+    for(size_t p = 0; p < T9LEX_PART_COUNT && written; p++) {
+        const LexiconPart* part = &t9plus_state.parts[p];
+        written = storage_file_write(file, part->arena, part->arena_size) == part->arena_size;
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    
+    if(written) {
+        storage_common_remove(storage, T9PLUS_SNAPSHOT_PATH);
+        written = storage_common_rename(storage, T9PLUS_SNAPSHOT_TEMP_PATH, T9PLUS_SNAPSHOT_PATH) == FSE_OK;
+    } else {
+        storage_common_remove(storage, T9PLUS_SNAPSHOT_TEMP_PATH);
+    }
+    furi_record_close(RECORD_STORAGE);
+    
+    if(written) {
+        t9plus_state.snapshot_stale = false;
+        FURI_LOG_I(TAG, "Wrote lexicon snapshot: %lu + %lu bytes",
+            (unsigned long)header.arena_size[0],
+            (unsigned long)header.arena_size[1]);
+    } else {
+        FURI_LOG_W(TAG, "Could not write the lexicon snapshot");
+    }
+}
+
+// Helper: Set the error message from the number of tier files missing so far
+static void update_load_errors(void) {
+    int failed_count = t9plus_state.failed_count;
+    if(failed_count > 0) {
+        t9plus_state.has_load_errors = true;
+        if(failed_count == T9LEX_TIER_COUNT) {
+            snprintf(t9plus_state.error_message, sizeof(t9plus_state.error_message), 
+                "ERROR: No data files found!");
+        } else {
+            snprintf(t9plus_state.error_message, sizeof(t9plus_state.error_message), 
+                "WARNING: %d data file(s) missing", failed_count);
+        }
+        FURI_LOG_W(TAG, "%s", t9plus_state.error_message);
+    } else {
+        t9plus_state.has_load_errors = false;
+        t9plus_state.error_message[0] = '\0';
+    }
+}
+
+// ============================================================================
+// USER DICTIONARY
+// ============================================================================
+
+// Helper: Index of the first user word whose first len characters do not sort before key.
+// The words with prefix key follow it contiguously.
+static size_t user_lower_bound(const char* key, size_t len) {
+    if(len > USER_WORD_SIZE) len = USER_WORD_SIZE;
+    size_t lo = 0;
+    size_t hi = t9plus_state.user_count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(prefix_compare(t9plus_state.user_words[mid].word, key, len) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Helper: Build the table key of a word as typed: lowercase, up to the first character that
+// is not a word character. False if the word is too short or too long to learn.
+static bool user_word_key(const char* word, char key[USER_WORD_SIZE]) {
+    size_t len = 0;
+    while(t9plus_is_word_char(word[len])) {
+        if(len >= USER_WORD_SIZE - 1) return false;
+        key[len] = tolower((unsigned char)word[len]);
+        len++;
+    }
+    key[len] = '\0';
+    return len >= USER_MIN_LENGTH && isalpha((unsigned char)key[0]);
+}
+
+// Helper: Add weight to a learned word, inserting it in order. When the table is full, the
+// word of least weight learned longest ago makes room.
+static void user_add(const char* key, uint16_t weight, bool capitalized) {
+    UserWord* words = t9plus_state.user_words;
+    size_t len = strlen(key);
+    size_t index = user_lower_bound(key, len + 1);
+    if(index < t9plus_state.user_count && strcmp(words[index].word, key) == 0) {
+        UserWord* entry = &words[index];
+        entry->weight = entry->weight + weight < USER_MAX_WEIGHT ? entry->weight + weight : USER_MAX_WEIGHT;
+        entry->capitalized = entry->capitalized && capitalized;
+        entry->last_used = ++t9plus_state.user_clock;
+        return;
+    }
+    
+    if(t9plus_state.user_count == USER_MAX_WORDS) {
+        size_t victim = 0;
+        for(size_t i = 1; i < USER_MAX_WORDS; i++) {
+            if(words[i].weight < words[victim].weight ||
+               (words[i].weight == words[victim].weight && words[i].last_used < words[victim].last_used)) {
+                victim = i;
+            }
+        }
+        T9PLUS_LOG_T(TAG, "User dictionary full, forgetting '%s'", words[victim].word);
+        memmove(&words[victim], &words[victim + 1], (USER_MAX_WORDS - victim - 1) * sizeof(UserWord));
+        t9plus_state.user_count--;
+        if(victim < index) index--;
+    }
+    
+    memmove(&words[index + 1], &words[index], (t9plus_state.user_count - index) * sizeof(UserWord));
+    UserWord* entry = &words[index];
+    memcpy(entry->word, key, len + 1);
+    entry->weight = weight < USER_MAX_WEIGHT ? weight : USER_MAX_WEIGHT;
+    entry->capitalized = capitalized;
+    entry->last_used = ++t9plus_state.user_clock;
+    t9plus_state.user_count++;
+}
+
+// Helper: Format a line of the user log, returns its length
+static size_t user_format_line(char* line, size_t size, const char* key, uint16_t weight, bool capitalized) {
+    char first = capitalized ? toupper((unsigned char)key[0]) : key[0];
+    return snprintf(line, size, "%u %c%s\n", weight, first, key + 1);
+}
+
+// Helper: Replay one line of the user log
+static void user_load_line(char* line, size_t len, void* context) {
+    UNUSED(context);
+    if(len == 0) return;
+    t9plus_state.user_log_lines++;
+    
+    char* word;
+    unsigned long weight = strtoul(line, &word, 10);
+    if(word == line || *word != ' ' || weight == 0) return;
+    word++;
+    
+    char key[USER_WORD_SIZE];
+    if(!user_word_key(word, key) || word[strlen(key)] != '\0') return;
+    user_add(key, weight < USER_MAX_WEIGHT ? weight : USER_MAX_WEIGHT, isupper((unsigned char)word[0]));
+}
+
+// Helper: Rewrite the user log as one line per word. The new log is written next to the old
+// one and renamed over it, so an interrupted compaction loses no learned word.
+static void user_compact(void) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    
+    bool written = storage_file_open(file, T9PLUS_USER_WORDS_TEMP_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    if(written) {
+        // Lines are collected into blocks, so a compaction costs a few writes
+        char* chunk = malloc(READ_CHUNK_SIZE);
+        size_t used = 0;
+        for(size_t i = 0; i <= t9plus_state.user_count && written; i++) {
+            const UserWord* entry = &t9plus_state.user_words[i];
+            if(i == t9plus_state.user_count || used + USER_WORD_SIZE + 8 > READ_CHUNK_SIZE) {
+                written = storage_file_write(file, chunk, used) == used;
+                used = 0;
+            }
+            if(i < t9plus_state.user_count) {
+                used += user_format_line(
+                    chunk + used, READ_CHUNK_SIZE - used, entry->word, entry->weight, entry->capitalized);
+            }
+        }
+        free(chunk);
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    
+    if(written) {
+        storage_common_remove(storage, T9PLUS_USER_WORDS_PATH);
+        written = storage_common_rename(storage, T9PLUS_USER_WORDS_TEMP_PATH, T9PLUS_USER_WORDS_PATH) == FSE_OK;
+    }
+    furi_record_close(RECORD_STORAGE);
+    
+    if(written) {
+        t9plus_state.user_log_lines = t9plus_state.user_count;
+        FURI_LOG_I(TAG, "Compacted user dictionary: %zu words", t9plus_state.user_count);
+    } else {
+        FURI_LOG_W(TAG, "Could not compact the user dictionary");
+    }
+}
+
+// Helper: Append one learn to the user log, false if it could not be written
+static bool user_log_append(const char* key, uint16_t weight, bool capitalized) {
+    char line[USER_WORD_SIZE + 8];
+    size_t len = user_format_line(line, sizeof(line), key, weight, capitalized);
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool written = storage_file_open(file, T9PLUS_USER_WORDS_PATH, FSAM_WRITE, FSOM_OPEN_APPEND) &&
+                   storage_file_write(file, line, len) == len;
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return written;
+}
+
+// Helper: Read the user dictionary by replaying its log. A compaction interrupted after the
+// old log was removed leaves only the new one, which is then renamed into place.
+static void user_load(void) {
+    t9plus_state.user_words = malloc(USER_MAX_WORDS * sizeof(UserWord));
+    t9plus_state.user_count = 0;
+    t9plus_state.user_log_lines = 0;
+    t9plus_state.user_clock = 0;
+    
+    if(!read_lines(T9PLUS_USER_WORDS_PATH, user_load_line, NULL) &&
+       read_lines(T9PLUS_USER_WORDS_TEMP_PATH, user_load_line, NULL)) {
+        user_compact();
+    }
+    FURI_LOG_I(TAG, "User dictionary: %zu words from %zu log lines",
+        t9plus_state.user_count,
+        t9plus_state.user_log_lines);
+    loader_publish(&t9plus_state.user_ready);
+}
+
+// Helper: Release the user dictionary, compacting its log first if it has grown
+static void user_free(void) {
+    if(loader_published(&t9plus_state.user_ready) &&
+       t9plus_state.user_log_lines > t9plus_state.user_count) {
+        user_compact();
+    }
+    free(t9plus_state.user_words);
+    t9plus_state.user_words = NULL;
+    t9plus_state.user_count = 0;
+    t9plus_state.user_log_lines = 0;
+    t9plus_state.user_ready = false;
+}
+
+// ============================================================================
+// FRAME TABLES
+// ============================================================================
+
+// Helper: Check the frames' gate and set references
+static bool frames_validate(const T9FrameHeader* header, const T9Frame* frames) {
+    if(header->set_count > 32) return false;
+    for(size_t f = 0; f < header->frame_count; f++) {
+        const T9Frame* frame = &frames[f];
+        if(frame->gate >= header->gate_count) return false;
+        if(frame->slot_count < 2 || frame->slot_count > T9FR_MAX_SLOTS) return false;
+        for(size_t i = 0; i < frame->slot_count; i++) {
+            if(frame->slots[i] >= header->set_count) return false;
+        }
+    }
+    return true;
+}
+
+// Helper: Read the frame tables into one arena, leaving room for the words' entry refs.
+// Frames are optional: without them suggestions are ranked by score alone.
+static void frames_load(void) {
+    char path[PACK_PATH_SIZE];
+    PACK_PATH(path, T9PLUS_FRAMES_FILE, t9plus_state.language);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    
+    T9FrameHeader header;
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+       storage_file_read(file, &header, sizeof(header)) == sizeof(header)) {
+        size_t gates_size = header.gate_count * sizeof(T9FrameGate);
+        size_t frames_size = header.frame_count * sizeof(T9Frame);
+        size_t words_size = header.word_count * sizeof(T9FrameWord);
+        size_t tables_size = gates_size + frames_size + words_size;
+        
+        if(header.magic != T9FR_MAGIC || header.version != T9FR_VERSION) {
+            FURI_LOG_W(TAG, "Frame tables have an unsupported header");
+        } else if(sizeof(header) + tables_size != storage_file_size(file)) {
+            FURI_LOG_W(TAG, "Frame tables truncated");
+        } else {
+            size_t refs_size = header.word_count * sizeof(uint16_t);
+            uint8_t* arena = malloc(tables_size + T9LEX_PART_COUNT * refs_size);
+            const T9Frame* frames = (const T9Frame*)(arena + gates_size);
+            if(storage_file_read(file, arena, tables_size) != tables_size ||
+               !frames_validate(&header, frames)) {
+                FURI_LOG_W(TAG, "Invalid frame tables");
+                free(arena);
+            } else {
+                T9FrameWord* words = (T9FrameWord*)(arena + gates_size + frames_size);
+                for(size_t i = 0; i < header.word_count; i++) {
+                    words[i].word[T9FR_WORD_SIZE - 1] = '\0';
+                }
+                t9plus_state.frame_arena = arena;
+                t9plus_state.frame_gates = (const T9FrameGate*)arena;
+                t9plus_state.frames = frames;
+                t9plus_state.frame_words = words;
+                for(size_t p = 0; p < T9LEX_PART_COUNT; p++) {
+                    t9plus_state.frame_refs[p] = (uint16_t*)(arena + tables_size + p * refs_size);
+                    memset(t9plus_state.frame_refs[p], 0xFF, refs_size); // T9LEX_NONE
+                }
+                t9plus_state.frame_gate_count = header.gate_count;
+                t9plus_state.frame_count = header.frame_count;
+                t9plus_state.frame_word_count = header.word_count;
+                t9plus_state.frame_question_sets = 0;
+                t9plus_state.frame_max_sentence_len = 0;
+                for(size_t g = 0; g < header.gate_count; g++) {
+                    const T9FrameGate* gate = &t9plus_state.frame_gates[g];
+                    if(gate->flags & T9FR_GATE_QUESTION) {
+                        t9plus_state.frame_question_sets |= gate->token_mask;
+                    }
+                    if(gate->min_sentence_len != T9FR_NO_SENTENCE_LEN &&
+                       gate->min_sentence_len > t9plus_state.frame_max_sentence_len) {
+                        t9plus_state.frame_max_sentence_len = gate->min_sentence_len;
+                    }
+                }
+                FURI_LOG_I(TAG, "Loaded %u frames over %u words", header.frame_count, header.word_count);
+            }
+        }
+    } else {
+        FURI_LOG_I(TAG, "No frame tables at %s", path);
+    }
+    
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+// Helper: Release the frame tables
+static void frames_free(void) {
+    free(t9plus_state.frame_arena);
+    t9plus_state.frame_arena = NULL;
+    t9plus_state.frame_gates = NULL;
+    t9plus_state.frames = NULL;
+    t9plus_state.frame_words = NULL;
+    memset(t9plus_state.frame_refs, 0, sizeof(t9plus_state.frame_refs));
+    t9plus_state.frame_gate_count = 0;
+    t9plus_state.frame_count = 0;
+    t9plus_state.frame_word_count = 0;
+    t9plus_state.frame_question_sets = 0;
+    t9plus_state.frame_max_sentence_len = 0;
+}
+
+// Helper: Find the best ranked entry of each frame word in a part that was just loaded,
+// so lookups can offer frame words without searching the tiers
+static void frames_resolve(size_t part_id) {
+    const LexiconPart* part = &t9plus_state.parts[part_id];
+    uint16_t* refs = t9plus_state.frame_refs[part_id];
+    if(!refs) return;
+    
+    size_t resolved = 0;
+    for(size_t i = 0; i < t9plus_state.frame_word_count; i++) {
+        const char* word = t9plus_state.frame_words[i].word;
+        uint32_t best_key = UINT32_MAX;
+        for(size_t t = 0; t < T9LEX_TIER_COUNT; t++) {
+            if(part_tier_count(part, t) == 0) continue;
+            size_t index = tier_find(lexicon_tiers[t], word);
+            if(index >= lexicon_tiers[t]->count) continue;
+            uint16_t ref = part->tier_base[t] + index;
+            uint32_t key = entry_key(part, ref);
+            if(key < best_key) {
+                best_key = key;
+                refs[i] = ref;
+            }
+        }
+        if(best_key != UINT32_MAX) resolved++;
+    }
+    T9PLUS_LOG_T(TAG, "Part %zu holds %zu of %zu frame words", part_id, resolved, t9plus_state.frame_word_count);
+}
+
+// Helper: Load a part from the compiled lexicon, falling back to its plain-text tier files,
+// and make it available to lookups
+static void lexicon_load_part(size_t part_id) {
+    char path[PACK_PATH_SIZE];
+    PACK_PATH(path, T9PLUS_LEXICON_FILE, t9plus_state.language);
+    uint8_t tiers = 0;
+    for(size_t t = 0; t < T9LEX_TIER_COUNT; t++) {
+        if(tier_part[t] == part_id) tiers++;
+    }
+    
+    uint32_t start = stats_cycles();
+    if(load_lexicon(path, part_id)) {
+        STATS_ADD(lexicon_load_us, stats_elapsed_us(start));
+        load_progress_add(tiers);
+    } else if(t9plus_state.language == LANGUAGE_DEFAULT) {
+        // Restoring the last run's build is one read; rebuilding parses the text tiers again
+        if(snapshot_load(part_id)) {
+            STATS_ADD(lexicon_load_us, stats_elapsed_us(start));
+            load_progress_add(tiers);
+        } else {
+            t9plus_state.failed_count += build_lexicon_from_text(part_id);
+            t9plus_state.snapshot_stale = true;
+        }
+        t9plus_state.snapshot_parts |= 1 << part_id;
+    } else {
+        // Another pack's tiers have no text files; the part stays unpublished and unsearched
+        t9plus_state.failed_count += tiers;
+        load_progress_add(tiers);
+        return;
+    }
+    STATS_SET(heap_resident,
+        t9plus_state.parts[LEXICON_PRIMARY].arena_size + t9plus_state.parts[LEXICON_DEFERRED].arena_size);
+    frames_resolve(part_id);
+    loader_publish(&t9plus_state.parts[part_id].ready);
+    loader_notify();
+}
+
+// Loader thread: the primary tiers first, so suggestions start as early as possible
+static int32_t loader_thread(void* context) {
+    UNUSED(context);
+    
+    // The user dictionary is small and ranks first, so it is published before the lexicon.
+    // It is shared by all packs and only loaded once.
+    if(!loader_published(&t9plus_state.user_ready)) user_load();
+    // Published along with the primary part
+    frames_load();
+    lexicon_reserve();
+    lexicon_load_part(LEXICON_PRIMARY);
+    lexicon_load_part(LEXICON_DEFERRED);
+    update_load_errors();
+    
+    FURI_LOG_I(TAG, "Loaded words: tier1=%zu, tier2=%zu, tier3a=%zu, tier3b=%zu, tier4=%zu",
+        t9plus_state.tier1.count,
+        t9plus_state.tier2.count,
+        t9plus_state.tier3a.count,
+        t9plus_state.tier3b.count,
+        t9plus_state.tier4.count);
+    
+    loader_publish(&t9plus_state.load_done);
+    loader_notify();
+    return 0;
+}
+
+// ============================================================================
+// NEXT-WORD PREDICTION
+// ============================================================================
+
+// Helper: Open the bigram table once, false if it is missing or has an unknown format.
+// The file and the storage record stay open until bigram_close().
+static bool bigram_open(void) {
+    if(t9plus_state.bigram_checked) return t9plus_state.bigram_file != NULL;
+    t9plus_state.bigram_checked = true;
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    T9BigramHeader header;
+    char path[PACK_PATH_SIZE];
+    PACK_PATH(path, T9PLUS_BIGRAM_FILE, t9plus_state.language);
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+       storage_file_read(file, &header, sizeof(header)) == sizeof(header) &&
+       header.magic == T9BG_MAGIC && header.version == T9BG_VERSION &&
+       header.record_size == sizeof(T9BigramRecord) &&
+       sizeof(header) + (uint64_t)header.record_count * sizeof(T9BigramRecord) <= storage_file_size(file)) {
+        t9plus_state.bigram_file = file;
+        t9plus_state.bigram_records = header.record_count;
+        FURI_LOG_I(TAG, "Bigram table: %lu previous words", (unsigned long)header.record_count);
+        return true;
+    }
+    
+    FURI_LOG_I(TAG, "No usable bigram table at %s", path);
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return false;
+}
+
+// Helper: Close the bigram table and forget the cached lookup
+static void bigram_close(void) {
+    if(t9plus_state.bigram_file) {
+        storage_file_close(t9plus_state.bigram_file);
+        storage_file_free(t9plus_state.bigram_file);
+        furi_record_close(RECORD_STORAGE);
+    }
+    t9plus_state.bigram_file = NULL;
+    t9plus_state.bigram_records = 0;
+    t9plus_state.bigram_checked = false;
+    t9plus_state.bigram_cached = false;
+}
+
+// Helper: Read one record of the bigram table, with its fields terminated
+static bool bigram_read(uint32_t index, T9BigramRecord* record) {
+    File* file = t9plus_state.bigram_file;
+    if(!storage_file_seek(file, sizeof(T9BigramHeader) + index * sizeof(T9BigramRecord), true) ||
+       storage_file_read(file, record, sizeof(*record)) != sizeof(*record)) {
+        return false;
+    }
+    record->prev[T9BG_WORD_SIZE - 1] = '\0';
+    for(size_t i = 0; i < T9BG_NEXT_COUNT; i++) {
+        record->next[i][T9BG_WORD_SIZE - 1] = '\0';
+    }
+    return true;
+}
+
+// Helper: Build the table key of a word: lowercase, up to the first whitespace, without
+// trailing punctuation. Returns false if nothing is left or the word is too long to be listed.
+static bool word_key(const char* word, char* key, size_t key_size) {
+    size_t len = 0;
+    while(word[len] && word[len] != ' ' && word[len] != '\n' && word[len] != '\r') {
+        if(len >= key_size - 1) return false;
+        key[len] = tolower((unsigned char)word[len]);
+        len++;
+    }
+    while(len > 0 && !t9plus_is_word_char(key[len - 1])) {
+        len--;
+    }
+    key[len] = '\0';
+    return len > 0;
+}
+
+// Helper: Binary search the bigram table for a key, O(log n) record reads.
+// Fills next with the key's next words and returns their number, 0 if it is not listed.
+static uint8_t bigram_search(const char* key, char next[T9BG_NEXT_COUNT][T9BG_WORD_SIZE]) {
+    T9BigramRecord record;
+    uint32_t lo = 0;
+    uint32_t hi = t9plus_state.bigram_records;
+    while(lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if(!bigram_read(mid, &record)) {
+            FURI_LOG_W(TAG, "Bigram table read failed");
+            return 0;
+        }
+        int cmp = strcmp(key, record.prev);
+        if(cmp == 0) {
+            uint8_t count = 0;
+            while(count < T9BG_NEXT_COUNT && record.next[count][0] != '\0') {
+                memcpy(next[count], record.next[count], T9BG_WORD_SIZE);
+                count++;
+            }
+            return count;
+        }
+        if(cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return 0;
+}
+
+// Helper: Predict the words following prev from the bigram table
+static uint8_t predict_next_words(
+    const char* prev,
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    uint8_t max_suggestions
+) {
+    char key[T9BG_WORD_SIZE];
+    if(!word_key(prev, key, sizeof(key)) || !bigram_open()) return 0;
+    
+    if(!t9plus_state.bigram_cached || strcmp(key, t9plus_state.bigram_key) != 0) {
+        t9plus_state.bigram_next_count = bigram_search(key, t9plus_state.bigram_next);
+        memcpy(t9plus_state.bigram_key, key, sizeof(key));
+        t9plus_state.bigram_cached = true;
+    }
+    
+    uint8_t found = 0;
+    while(found < max_suggestions && found < t9plus_state.bigram_next_count) {
+        T9PLUS_LOG_T(TAG, "  Next word %d: '%s'", found, t9plus_state.bigram_next[found]);
+        memcpy(suggestions[found], t9plus_state.bigram_next[found], T9BG_WORD_SIZE);
+        found++;
+    }
+    return found;
+}
+
+// ============================================================================
+// DICTIONARY
+// ============================================================================
+
+// Helper: Open the dictionary once and read its index, false if it is missing or invalid.
+// The file and the storage record stay open until dict_close().
+static bool dict_open(void) {
+    if(t9plus_state.dict_checked) return t9plus_state.dict_file != NULL;
+    t9plus_state.dict_checked = true;
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    size_t cache_size = DICT_CACHE_BLOCKS * sizeof(DictCacheSlot);
+    size_t index_size = (T9DX_BUCKETS + 1) * sizeof(uint16_t);
+    uint8_t* arena = malloc(cache_size + index_size);
+    uint16_t* index = (uint16_t*)(arena + cache_size);
+    
+    T9DictHeader header;
+    char path[PACK_PATH_SIZE];
+    PACK_PATH(path, T9PLUS_DICT_FILE, t9plus_state.language);
+    bool valid = storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+                 storage_file_read(file, &header, sizeof(header)) == sizeof(header) &&
+                 header.magic == T9DX_MAGIC && header.version == T9DX_VERSION &&
+                 header.block_size == T9DX_BLOCK_SIZE && header.tops_block < header.words_block &&
+                 storage_file_read(file, index, index_size) == index_size;
+    
+    // Buckets must be in order and within the word blocks
+    for(size_t b = 0; valid && b < T9DX_BUCKETS; b++) {
+        valid = index[b] >= header.words_block && index[b] <= index[b + 1];
+    }
+    if(valid) {
+        valid = ((uint64_t)index[T9DX_BUCKETS] + 1) * T9DX_BLOCK_SIZE <= storage_file_size(file);
+    }
+    
+    if(valid) {
+        memset(arena, 0, cache_size);
+        t9plus_state.dict_file = file;
+        t9plus_state.dict_cache = (DictCacheSlot*)arena;
+        t9plus_state.dict_index = index;
+        t9plus_state.dict_tops_block = header.tops_block;
+        t9plus_state.dict_words_block = header.words_block;
+        t9plus_state.dict_clock = 0;
+        FURI_LOG_I(TAG, "Dictionary: %lu words in %u blocks",
+            (unsigned long)header.word_count, index[T9DX_BUCKETS] + 1 - header.words_block);
+        return true;
+    }
+    
+    FURI_LOG_I(TAG, "No usable dictionary at %s", path);
+    free(arena);
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return false;
+}
+
+// Helper: Close the dictionary and release its index and block cache
+static void dict_close(void) {
+    if(t9plus_state.dict_file) {
+        storage_file_close(t9plus_state.dict_file);
+        storage_file_free(t9plus_state.dict_file);
+        furi_record_close(RECORD_STORAGE);
+        free(t9plus_state.dict_cache);
+    }
+    t9plus_state.dict_file = NULL;
+    t9plus_state.dict_cache = NULL;
+    t9plus_state.dict_index = NULL;
+    t9plus_state.dict_checked = false;
+}
+
+// Helper: Forget all cached results. The words stay in place, since the last list handed
+// out may still point at them; result_cache_victim() keeps that slot until the next list.
+static void result_cache_clear(void) {
+    for(size_t i = 0; i < RESULT_CACHE_SLOTS; i++) {
+        t9plus_state.result_cache[i].last_used = 0;
+    }
+    t9plus_state.result_clock = 0;
+}
+
+// Helper: Start loading the current pack on a separate thread; lookups skip every part the
+// loader has not published yet
+static void loader_start(void) {
+    t9plus_state.failed_count = 0;
+    t9plus_state.tiers_loaded = 0;
+    t9plus_state.load_done = false;
+    t9plus_state.loader = furi_thread_alloc_ex("T9PlusLoader", LOADER_STACK_SIZE, loader_thread, NULL);
+    furi_thread_start(t9plus_state.loader);
+}
+
+bool t9plus_init(void) {
+    if(t9plus_state.initialized) {
+        FURI_LOG_W(TAG, "Already initialized");
+        return true;
+    }
+    
+    FURI_LOG_I(TAG, "Initializing T9+ prediction system");
+    
+#if T9PLUS_STATS
+    memset(&t9plus_state.stats, 0, sizeof(t9plus_state.stats));
+    t9plus_state.stats_heap_before = memmgr_get_free_heap();
+#endif
+    
+    result_cache_clear();
+    t9plus_state.snapshot_stamped = false;  // The sources may have changed since the last run
+    loader_start();
+    
+    t9plus_state.initialized = true;
+    return true;
+}
+
+bool t9plus_is_ready(void) {
+    // A pack whose lexicon could not be read is ready once the loader gave up on it
+    return t9plus_state.initialized && (part_is_ready(&t9plus_state.parts[LEXICON_PRIMARY]) ||
+                                        loader_published(&t9plus_state.load_done));
+}
+
+void t9plus_set_load_callback(T9PlusLoadCallback callback, void* context) {
+    t9plus_state.load_callback = callback;
+    t9plus_state.load_context = context;
+}
+
+uint8_t t9plus_get_load_progress(void) {
+    if(!t9plus_state.initialized) return 0;
+    if(loader_published(&t9plus_state.load_done)) return 100;
+    
+    // Sorting and indexing follow the last tier read, so stop short of 100 until done
+    uint8_t tiers = __atomic_load_n(&t9plus_state.tiers_loaded, __ATOMIC_RELAXED);
+    uint8_t progress = tiers * 100 / T9LEX_TIER_COUNT;
+    return progress < 99 ? progress : 99;
+}
+
+void t9plus_deinit(void) {
+    if(!t9plus_state.initialized) return;
+    
+    FURI_LOG_I(TAG, "Shutting down T9+");
+    
+    // Let a load in progress finish before its memory is released
+    furi_thread_join(t9plus_state.loader);
+    furi_thread_free(t9plus_state.loader);
+    t9plus_state.loader = NULL;
+    
+#if T9PLUS_STATS
+    t9plus_log_stats();
+#endif
+    snapshot_save();
+    lexicon_free();
+    frames_free();
+    bigram_close();
+    dict_close();
+    user_free();
+    result_cache_clear();
+    t9plus_state.load_callback = NULL;
+    
+    t9plus_state.initialized = false;
+}
+
+bool t9plus_is_word_char(char c) {
+    return isalnum((unsigned char)c) || c == '\'';
+}
+
+const char* t9plus_get_error_message(void) {
+    if(!t9plus_state.initialized) {
+        return "T9+ not initialized";
+    }
+    
+    // Missing files are only known once the loader is done
+    if(!loader_published(&t9plus_state.load_done)) {
+        return NULL;
+    }
+    
+    if(t9plus_state.has_load_errors) {
+        return t9plus_state.error_message;
+    }
+    
+    return NULL;  // No error
+}
+
+// ============================================================================
+// LANGUAGE PACKS
+// ============================================================================
+
+uint8_t t9plus_get_language_count(void) {
+    return LANGUAGE_COUNT;
+}
+
+const char* t9plus_get_language_name(uint8_t language) {
+    return language < LANGUAGE_COUNT ? language_packs[language].name : NULL;
+}
+
+uint8_t t9plus_get_language(void) {
+    return t9plus_state.language;
+}
+
+bool t9plus_set_language(uint8_t language) {
+    if(!t9plus_state.initialized || language >= LANGUAGE_COUNT) return false;
+    if(language == t9plus_state.language) return true;
+    if(!loader_published(&t9plus_state.load_done)) {
+        FURI_LOG_W(TAG, "Still loading, staying with %s", language_packs[t9plus_state.language].name);
+        return false;
+    }
+    
+    // Only the default pack can be built from text files
+    T9LexHeader header;
+    if(language != LANGUAGE_DEFAULT && !lexicon_pack_header(language, &header)) {
+        FURI_LOG_W(TAG, "Language pack %s is not installed", language_packs[language].name);
+        return false;
+    }
+    
+    FURI_LOG_I(TAG, "Switching to language pack %s", language_packs[language].name);
+    furi_thread_join(t9plus_state.loader);
+    furi_thread_free(t9plus_state.loader);
+    
+    // The loader is done and lookups run on this thread, so nothing reads the old pack any more.
+    // A default pack rebuilt from text is kept first, as on exit; unloading forgets it was rebuilt.
+    // Its arenas are kept and the new pack is read into them.
+    if(t9plus_state.language == LANGUAGE_DEFAULT) snapshot_save();
+    lexicon_unload();
+    frames_free();
+    bigram_close();
+    dict_close();
+    result_cache_clear();
+    t9plus_state.language = language;
+    loader_start();
+    return true;
+}
+
+// Helper: Copy a tier word into a suggestion slot, restoring its capitalization
+static void copy_suggestion(char* dst, const WordTier* tier, size_t index) {
+    strncpy(dst, tier_word(tier, index), T9PLUS_MAX_WORD_LENGTH - 1);
+    dst[T9PLUS_MAX_WORD_LENGTH - 1] = '\0';
+    if(tier->ranks[index] & T9LEX_RANK_CAPITALIZED) {
+        dst[0] = toupper((unsigned char)dst[0]);
+    }
+}
+
+static const TriePos trie_root = {.node = 0, .end = 0};
+
+// Helper: Advance a trie position for prefix[0, depth) by the lowercase character c
+static TriePos trie_step(const LexiconPart* part, TriePos pos, size_t depth, char c) {
+    const TriePos dead = {.node = T9LEX_NONE, .end = 0};
+    if(pos.node == T9LEX_NONE) return dead;
+    
+    // Still inside the current edge label
+    if(depth < pos.end) {
+        const char* label = entry_word(part, part->nodes[pos.node].label_ref);
+        return label[depth] == c ? pos : dead;
+    }
+    
+    const T9LexNode* node = &part->nodes[pos.node];
+    for(size_t i = 0; i < node->child_count; i++) {
+        uint16_t child = node->first_child + i;
+        const T9LexNode* candidate = &part->nodes[child];
+        if(entry_word(part, candidate->label_ref)[depth] == c) {
+            return (TriePos){.node = child, .end = depth + candidate->label_len};
+        }
+    }
+    return dead;
+}
+
+// Helper: Walk a part's trie along a lowercase prefix, returns NULL if no word has that prefix
+static const T9LexNode* trie_find(const LexiconPart* part, const char* prefix, size_t prefix_len) {
+    TriePos pos = trie_root;
+    size_t depth = 0;
+    while(depth < prefix_len) {
+        // The first character picks the child, the rest of its label is compared at once
+        pos = trie_step(part, pos, depth, prefix[depth]);
+        if(pos.node == T9LEX_NONE) return NULL;
+        size_t end = pos.end < prefix_len ? pos.end : prefix_len;
+        const char* label = entry_word(part, part->nodes[pos.node].label_ref);
+        if(prefix_compare(label + depth + 1, prefix + depth + 1, end - depth - 1) != 0) return NULL;
+        depth = end;
+    }
+    return &part->nodes[pos.node];
+}
+
+// Helper: Offer the cached completions of a part's trie node to a top-K list.
+// They are sorted by key, so the first one rejected ends the scan.
+static void topk_add_node(TopK* top, const LexiconPart* part, const T9LexNode* node) {
+    for(size_t i = 0; i < T9LEX_TOP_COUNT && node->top[i] != T9LEX_NONE; i++) {
+        if(!topk_insert(top, part, node->top[i])) break;
+    }
+}
+
+// Helper: Set masks of a finished word in the frame tables, 0 if it is in no token set
+static uint32_t frames_word_sets(const char* word) {
+    // The tables are published along with the primary part
+    if(!part_is_ready(&t9plus_state.parts[LEXICON_PRIMARY]) || !t9plus_state.frame_words) return 0;
+    
+    char key[T9FR_WORD_SIZE];
+    if(!word_key(word, key, sizeof(key))) return 0;
+    size_t lo = 0;
+    size_t hi = t9plus_state.frame_word_count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(t9plus_state.frame_words[mid].word, key);
+        if(cmp == 0) return t9plus_state.frame_words[mid].sets;
+        if(cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return 0;
+}
+
+// Helper: Whether any condition of a gate holds in a context
+static bool gate_is_open(const T9FrameGate* gate, const GateContext* ctx) {
+    return (gate->flags & T9FR_GATE_ALWAYS) ||
+           ((gate->flags & T9FR_GATE_QUESTION) && ctx->is_question) ||
+           (gate->register_mask & ctx->register_bit) ||
+           (gate->punct_mask & ctx->punct) ||
+           (gate->token_mask & ctx->tokens[0]) ||
+           (gate->min_sentence_len != T9FR_NO_SENTENCE_LEN && ctx->sentence_len >= gate->min_sentence_len);
+}
+
+// Sets expected for the current word by the frames that match the words before it
+#define FRAME_MAX_EXPECTED 8
+typedef struct {
+    uint32_t sets[FRAME_MAX_EXPECTED];
+    uint16_t scales[FRAME_MAX_EXPECTED]; // Q8 score scale of each expected set
+    uint8_t count;
+} FrameExpectation;
+
+// Helper: Collect the slots that open frames expect next. A frame whose first k slots hold
+// the last k words expects its slot k, with the score scale of the frame's gate.
+static void frames_expect(const GateContext* ctx, FrameExpectation* expect) {
+    expect->count = 0;
+    for(size_t f = 0; f < t9plus_state.frame_count; f++) {
+        const T9Frame* frame = &t9plus_state.frames[f];
+        const T9FrameGate* gate = &t9plus_state.frame_gates[frame->gate];
+        if(frame->register_mask && ctx->register_bit && !(frame->register_mask & ctx->register_bit)) continue;
+        if(!gate_is_open(gate, ctx)) continue;
+        
+        for(size_t k = 1; k < frame->slot_count && k <= FRAME_HISTORY; k++) {
+            bool match = true;
+            for(size_t j = 0; j < k && match; j++) {
+                match = ctx->tokens[k - 1 - j] & (1UL << frame->slots[j]);
+            }
+            if(!match || expect->count >= FRAME_MAX_EXPECTED) continue;
+            expect->sets[expect->count] = 1UL << frame->slots[k];
+            expect->scales[expect->count] = gate->score_scale;
+            expect->count++;
+        }
+    }
+}
+
+// Helper: Apply a Q8 score scale to the score byte of an ordering key
+static inline uint32_t frame_scale_key(uint32_t key, uint16_t scale) {
+    uint32_t score = ((key >> 24) * scale) >> 8;
+    if(score > UINT8_MAX) score = UINT8_MAX;
+    return (score << 24) | (key & 0x00FFFFFF);
+}
+
+// Helper: Offer the frame words expected in a context that start with a lowercase prefix,
+// each by its best loaded entry with its score scaled by the strongest expecting gate
+static void topk_add_frames(TopK* top, const GateContext* ctx, const char* prefix, size_t prefix_len) {
+    if(!part_is_ready(&t9plus_state.parts[LEXICON_PRIMARY]) || !t9plus_state.frame_words) return;
+    
+    FrameExpectation expect;
+    frames_expect(ctx, &expect);
+    if(expect.count == 0) return;
+    
+    // Frame words are sorted, so the words with the prefix form one run
+    const T9FrameWord* words = t9plus_state.frame_words;
+    size_t len = prefix_len < T9FR_WORD_SIZE ? prefix_len : T9FR_WORD_SIZE;
+    size_t lo = 0;
+    size_t hi = t9plus_state.frame_word_count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(prefix_compare(words[mid].word, prefix, len) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    
+    for(size_t i = lo; i < t9plus_state.frame_word_count; i++) {
+        if(prefix_compare(words[i].word, prefix, len) != 0) break;
+        
+        uint16_t scale = UINT16_MAX;
+        for(size_t e = 0; e < expect.count; e++) {
+            if((words[i].sets & expect.sets[e]) && expect.scales[e] < scale) scale = expect.scales[e];
+        }
+        if(scale == UINT16_MAX) continue;
+        
+        const LexiconPart* best_part = NULL;
+        uint16_t best_ref = T9LEX_NONE;
+        uint32_t best_key = UINT32_MAX;
+        for(size_t p = 0; p < T9LEX_PART_COUNT; p++) {
+            const LexiconPart* part = &t9plus_state.parts[p];
+            if(!part_is_ready(part)) continue;
+            uint16_t ref = t9plus_state.frame_refs[p][i];
+            if(ref == T9LEX_NONE) continue;
+            uint32_t key = entry_key(part, ref);
+            if(key < best_key) {
+                best_key = key;
+                best_part = part;
+                best_ref = ref;
+            }
+        }
+        if(best_part) {
+            T9PLUS_LOG_T(TAG, "  Frame word '%s' (scale %u)", words[i].word, scale);
+            topk_insert_key(top, best_part, best_ref, frame_scale_key(best_key, scale));
+        }
+    }
+}
+
+// Helper: Whether a word is among the first count suggestions, ignoring case
+static bool suggestion_listed(
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    uint8_t count,
+    const char* word
+) {
+    for(uint8_t i = 0; i < count; i++) {
+        if(strcasecmp(suggestions[i], word) == 0) return true;
+    }
+    return false;
+}
+
+// Helper: Class of a character in the dictionary's bucket index, monotonic in byte order
+static inline size_t dict_class(char c) {
+    unsigned char b = c;
+    if(b < 'a') return 0;
+    return b <= 'z' ? (size_t)(b - 'a' + 1) : T9DX_CLASSES - 1;
+}
+
+// Helper: A dictionary block through the LRU block cache, NULL if it cannot be read
+static const uint8_t* dict_block(uint16_t block) {
+    DictCacheSlot* cache = t9plus_state.dict_cache;
+    DictCacheSlot* victim = &cache[0];
+    uint32_t clock = ++t9plus_state.dict_clock;
+    for(size_t i = 0; i < DICT_CACHE_BLOCKS; i++) {
+        if(cache[i].last_used && cache[i].block == block) {
+            cache[i].last_used = clock;
+            STATS_ADD(dict_cache_hits, 1);
+            return cache[i].data;
+        }
+        if(cache[i].last_used < victim->last_used) victim = &cache[i];
+    }
+    
+    File* file = t9plus_state.dict_file;
+    if(!storage_file_seek(file, (uint32_t)block * T9DX_BLOCK_SIZE, true) ||
+       storage_file_read(file, victim->data, T9DX_BLOCK_SIZE) != T9DX_BLOCK_SIZE) {
+        FURI_LOG_W(TAG, "Dictionary block %u read failed", block);
+        victim->last_used = 0;
+        return NULL;
+    }
+    STATS_ADD(dict_block_reads, 1);
+    victim->block = block;
+    victim->last_used = clock;
+    return victim->data;
+}
+
+// Helper: Decode the entry at offset of a word block into a word and its capitalization flag.
+// Returns the offset after the entry, 0 if the entry is invalid.
+static size_t dict_decode(const uint8_t* data, size_t offset, DictWord* out, bool* capitalized) {
+    if(offset + T9DX_ENTRY_HEADER > T9DX_BLOCK_SIZE) return 0;
+    size_t len = data[offset + 2] & T9DX_LENGTH_MASK;
+    if(len == 0 || len >= MAX_WORD_LEN || offset + T9DX_ENTRY_HEADER + len > T9DX_BLOCK_SIZE) return 0;
+    out->rank = data[offset] | (data[offset + 1] << 8);
+    memcpy(out->word, data + offset + T9DX_ENTRY_HEADER, len);
+    out->word[len] = '\0';
+    *capitalized = data[offset + 2] & T9DX_CAPITALIZED;
+    return offset + T9DX_ENTRY_HEADER + len;
+}
+
+// Best dictionary words of a lookup by rank, best first
+typedef struct {
+    DictWord words[T9PLUS_MAX_SUGGESTIONS];
+    uint8_t count;
+    uint8_t limit; // Words still needed
+} DictCandidates;
+
+// Helper: Offer a decoded word to the dictionary candidates, unless it is already suggested
+static void dict_offer(
+    DictCandidates* cands,
+    DictWord* word,
+    bool capitalized,
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    uint8_t found
+) {
+    if(suggestion_listed(suggestions, found, word->word)) return;
+    uint8_t slot = cands->count;
+    for(uint8_t i = 0; i < cands->count; i++) {
+        if(strcmp(cands->words[i].word, word->word) == 0) return;
+        if(slot == cands->count && cands->words[i].rank > word->rank) slot = i;
+    }
+    if(slot >= cands->limit) return;
+    
+    if(capitalized) word->word[0] = toupper((unsigned char)word->word[0]);
+    if(cands->count < cands->limit) cands->count++;
+    for(uint8_t j = cands->count - 1; j > slot; j--) {
+        cands->words[j] = cands->words[j - 1];
+    }
+    cands->words[slot] = *word;
+}
+
+// Helper: Offer the precomputed best words of a prefix of one or two letters,
+// false if the prefix has no top record
+static bool dict_offer_tops(
+    const char* prefix,
+    size_t len,
+    DictCandidates* cands,
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    uint8_t found
+) {
+    size_t first = dict_class(prefix[0]);
+    size_t second = len > 1 ? dict_class(prefix[1]) : 0;
+    bool letters = first > 0 && first < T9DX_CLASSES - 1 && (len == 1 || (second > 0 && second < T9DX_CLASSES - 1));
+    if(len > 2 || !letters) return false;
+    
+    size_t record = len == 1 ? T9DX_BUCKETS + first : first * T9DX_CLASSES + second;
+    size_t pos = record * sizeof(T9DictTop);
+    const uint8_t* data = dict_block(t9plus_state.dict_tops_block + pos / T9DX_BLOCK_SIZE);
+    if(!data) return true;
+    T9DictTop top;
+    memcpy(&top, data + pos % T9DX_BLOCK_SIZE, sizeof(top));
+    
+    for(size_t i = 0; i < T9DX_TOP_COUNT && top.refs[i] != T9DX_NO_REF; i++) {
+        uint16_t block = top.refs[i] >> 16;
+        if(block < t9plus_state.dict_words_block || block > t9plus_state.dict_index[T9DX_BUCKETS]) break;
+        const uint8_t* words = dict_block(block);
+        DictWord word;
+        bool capitalized;
+        if(!words || !dict_decode(words, top.refs[i] & 0xFFFF, &word, &capitalized)) break;
+        dict_offer(cands, &word, capitalized, suggestions, found);
+    }
+    return true;
+}
+
+// Helper: Offer the words with a prefix from a scan of at most DICT_MAX_SCAN_BLOCKS blocks,
+// starting at the block found by a binary search over the prefix's buckets
+static void dict_offer_scan(
+    const char* prefix,
+    size_t len,
+    DictCandidates* cands,
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    uint8_t found
+) {
+    size_t first = dict_class(prefix[0]) * T9DX_CLASSES;
+    size_t last = first + (len > 1 ? dict_class(prefix[1]) : T9DX_CLASSES - 1);
+    if(len > 1) first = last;
+    const uint16_t* index = t9plus_state.dict_index;
+    uint16_t lo = index[first];
+    uint16_t end = index[last + 1];
+    
+    // Last block whose first word sorts before the prefix
+    uint16_t hi = end;
+    while(lo < hi) {
+        uint16_t mid = lo + (hi - lo + 1) / 2;
+        const uint8_t* data = dict_block(mid);
+        DictWord word;
+        bool capitalized;
+        if(!data || !dict_decode(data, 1, &word, &capitalized)) return;
+        if(strcmp(word.word, prefix) < 0) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    
+    for(uint32_t block = lo; block <= end && block < (uint32_t)lo + DICT_MAX_SCAN_BLOCKS; block++) {
+        const uint8_t* data = dict_block(block);
+        if(!data) return;
+        size_t offset = 1;
+        for(size_t i = 0; i < data[0]; i++) {
+            DictWord word;
+            bool capitalized;
+            offset = dict_decode(data, offset, &word, &capitalized);
+            if(!offset) return;
+            int cmp = prefix_compare(word.word, prefix, len);
+            if(cmp > 0) return;
+            if(cmp == 0) dict_offer(cands, &word, capitalized, suggestions, found);
+        }
+    }
+}
+
+// Helper: Fill the suggestion slots left after the lexicon from the dictionary,
+// by dictionary rank. Needs no SD access while the lexicon fills every slot.
+static uint8_t dict_suggest(
+    const char* prefix,
+    size_t prefix_len,
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    uint8_t found,
+    uint8_t max_suggestions
+) {
+    if(found >= max_suggestions || prefix_len == 0 || prefix_len >= MAX_WORD_LEN || !dict_open()) {
+        return found;
+    }
+    
+    char key[MAX_WORD_LEN];
+    memcpy(key, prefix, prefix_len);
+    key[prefix_len] = '\0';
+    
+    DictCandidates cands = {.count = 0, .limit = max_suggestions - found};
+    if(!dict_offer_tops(key, prefix_len, &cands, suggestions, found) || cands.count < cands.limit) {
+        dict_offer_scan(key, prefix_len, &cands, suggestions, found);
+    }
+    for(uint8_t i = 0; i < cands.count; i++) {
+        T9PLUS_LOG_T(TAG, "  Dictionary suggestion %d: '%s' (rank %u)", found, cands.words[i].word, cands.words[i].rank);
+        memcpy(suggestions[found++], cands.words[i].word, T9PLUS_MAX_WORD_LENGTH);
+    }
+    return found;
+}
+
+// Helper: Append the best candidates of a top-K list to the found suggestions. No two lexicon
+// entries spell the same word, so only the words found before by other sources can repeat one.
+static uint8_t copy_top_suggestions(
+    const TopK* top,
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    uint8_t found,
+    uint8_t max_suggestions
+) {
+    uint8_t listed = found;
+    for(uint8_t i = 0; i < top->count && found < max_suggestions; i++) {
+        size_t index;
+        const WordTier* tier = entry_tier(top->parts[i], top->refs[i], &index);
+        copy_suggestion(suggestions[found], tier, index);
+        if(suggestion_listed(suggestions, listed, suggestions[found])) continue;
+        T9PLUS_LOG_T(
+            TAG,
+            "  Suggestion %d: '%s' (score %d, tiers 0x%02x)",
+            found,
+            tier_word(tier, index),
+            tier->scores[index],
+            (tier->ranks[index] & ~T9LEX_RANK_CAPITALIZED) >> T9LEX_RANK_TIERS_SHIFT);
+        found++;
     }
-    tier->count = 0;
-    tier->capacity = 0;
+    return found;
 }
 
-// Helper: Add word to tier
-static bool tier_add_word(WordTier* tier, const char* word) {
-    if(tier->count >= tier->capacity) return false;
-    
-    tier->words[tier->count] = strdup(word);
-    if(!tier->words[tier->count]) return false;
-    
-    tier->count++;
-    return true;
+// Helper: Suggestions for an empty current word: predictions from the previous word, then
+// the words expected by the frames the previous words open
+static uint8_t suggest_next_word(
+    const char* prev,
+    const GateContext* ctx,
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    uint8_t max_suggestions
+) {
+    uint8_t found = predict_next_words(prev, suggestions, max_suggestions);
+    TopK top = {0};
+    topk_add_frames(&top, ctx, "", 0);
+    return copy_top_suggestions(&top, suggestions, found, max_suggestions);
 }
 
-// Helper: Load words from file
-static bool load_tier_from_file(const char* path, WordTier* tier) {
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    File* file = storage_file_alloc(storage);
-    
-    FURI_LOG_I(TAG, "Loading tier from: %s", path);
+// Helper: Whether a learned word ranks before another: by weight, then by the latest learn
+static inline bool user_ranks_before(const UserWord* a, const UserWord* b) {
+    return a->weight > b->weight || (a->weight == b->weight && a->last_used > b->last_used);
+}
+
+// Helper: Fill suggestion slots with the learned words that start with a lowercase prefix,
+// best first. Binary search finds the first of them, so only matching words are visited.
+static uint8_t user_suggest(
+    const char* prefix,
+    size_t prefix_len,
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    uint8_t max_suggestions
+) {
+    if(!loader_published(&t9plus_state.user_ready)) return 0;
     
-    bool success = false;
-    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
-        FURI_LOG_I(TAG, "File opened successfully: %s", path);
-        char buffer[MAX_WORD_LEN + 2]; // +2 for newline and null terminator
-        size_t bytes_read;
-        size_t pos = 0;
-        
-        while(true) {
-            bytes_read = storage_file_read(file, buffer + pos, 1);
-            if(bytes_read == 0) {
-                // End of file - process last word if exists
-                if(pos > 0) {
-                    buffer[pos] = '\0';
-                    // Trim whitespace
-                    while(pos > 0 && isspace((unsigned char)buffer[pos - 1])) {
-                        buffer[--pos] = '\0';
-                    }
-                    if(pos > 0 && buffer[0] != '#') {
-                        tier_add_word(tier, buffer);
-                    }
-                }
-                break;
-            }
-            
-            // Check for newline
-            if(buffer[pos] == '\n' || buffer[pos] == '\r') {
-                buffer[pos] = '\0';
-                // Trim trailing whitespace
-                while(pos > 0 && isspace((unsigned char)buffer[pos - 1])) {
-                    buffer[--pos] = '\0';
-                }
-                
-                // Add word if not empty and not a comment
-                if(pos > 0 && buffer[0] != '#') {
-                    tier_add_word(tier, buffer);
-                }
-                pos = 0;
-            } else if(pos < MAX_WORD_LEN) {
-                pos++;
-            } else {
-                // Word too long, skip to next line
-                while(bytes_read > 0 && buffer[pos] != '\n' && buffer[pos] != '\r') {
-                    bytes_read = storage_file_read(file, buffer + pos, 1);
-                }
-                pos = 0;
-            }
+    const UserWord* best[T9PLUS_MAX_SUGGESTIONS];
+    uint8_t count = 0;
+    const UserWord* words = t9plus_state.user_words;
+    size_t len = prefix_len < USER_WORD_SIZE ? prefix_len : USER_WORD_SIZE;
+    for(size_t i = user_lower_bound(prefix, len);
+        i < t9plus_state.user_count && prefix_compare(words[i].word, prefix, len) == 0;
+        i++) {
+        const UserWord* entry = &words[i];
+        if(entry->weight < USER_MIN_WEIGHT) continue;
+        uint8_t slot = count;
+        while(slot > 0 && user_ranks_before(entry, best[slot - 1])) {
+            slot--;
         }
-        
-        success = true;
-        FURI_LOG_I(TAG, "Loaded %zu words from %s", tier->count, path);
-        storage_file_close(file);
-    } else {
-        FURI_LOG_E(TAG, "Failed to open file: %s", path);
+        if(slot >= max_suggestions) continue;
+        if(count < max_suggestions) count++;
+        memmove(&best[slot + 1], &best[slot], (count - 1 - slot) * sizeof(best[0]));
+        best[slot] = entry;
     }
     
-    storage_file_free(file);
-    furi_record_close(RECORD_STORAGE);
-    
-    return success;
+    for(uint8_t i = 0; i < count; i++) {
+        memcpy(suggestions[i], best[i]->word, USER_WORD_SIZE);
+        if(best[i]->capitalized) suggestions[i][0] = toupper((unsigned char)suggestions[i][0]);
+        T9PLUS_LOG_T(TAG, "  Suggestion %d: '%s' (learned, weight %u)", i, suggestions[i], best[i]->weight);
+    }
+    return count;
 }
 
-bool t9plus_init(void) {
-    if(t9plus_state.initialized) {
-        FURI_LOG_W(TAG, "Already initialized");
-        return true;
-    }
-    
-    FURI_LOG_I(TAG, "Initializing T9+ prediction system");
+// ============================================================================
+// FUZZY COMPLETION
+// ============================================================================
+
+// Helper: Record a neighbour of a key on the keyboard, unless it is already listed
+static void key_add_neighbor(char key, char neighbor) {
+    key = tolower((unsigned char)key);
+    neighbor = tolower((unsigned char)neighbor);
+    if((unsigned char)key >= FUZZY_KEY_COUNT || key == neighbor) return;
     
-    // Allocate tiers
-    if(!tier_alloc(&t9plus_state.tier1, MAX_TIER_WORDS)) {
-        FURI_LOG_E(TAG, "Failed to allocate tier1");
-        return false;
-    }
-    if(!tier_alloc(&t9plus_state.tier2, MAX_TIER_WORDS)) {
-        FURI_LOG_E(TAG, "Failed to allocate tier2");
-        tier_free(&t9plus_state.tier1);
-        return false;
+    char* neighbors = t9plus_state.key_neighbors[(unsigned char)key];
+    for(size_t i = 0; i < FUZZY_NEIGHBORS; i++) {
+        if(neighbors[i] == neighbor) return;
+        if(neighbors[i] == '\0') {
+            neighbors[i] = neighbor;
+            return;
+        }
     }
-    if(!tier_alloc(&t9plus_state.tier3a, MAX_TIER_WORDS)) {
-        FURI_LOG_E(TAG, "Failed to allocate tier3a");
-        tier_free(&t9plus_state.tier1);
-        tier_free(&t9plus_state.tier2);
-        return false;
+}
+
+void t9plus_set_key_layout(const char* const* lines, size_t line_count) {
+    memset(t9plus_state.key_neighbors, 0, sizeof(t9plus_state.key_neighbors));
+    for(size_t line = 0; line < line_count; line++) {
+        size_t len = strlen(lines[line]);
+        for(size_t pos = 0; pos < len; pos++) {
+            char key = lines[line][pos];
+            if(pos > 0) key_add_neighbor(key, lines[line][pos - 1]);
+            if(pos + 1 < len) key_add_neighbor(key, lines[line][pos + 1]);
+            // Up and Down keep the position within the line
+            if(line > 0 && pos < strlen(lines[line - 1])) key_add_neighbor(key, lines[line - 1][pos]);
+            if(line + 1 < line_count && pos < strlen(lines[line + 1])) key_add_neighbor(key, lines[line + 1][pos]);
+        }
     }
-    if(!tier_alloc(&t9plus_state.tier3b, MAX_TIER_WORDS)) {
-        FURI_LOG_E(TAG, "Failed to allocate tier3b");
-        tier_free(&t9plus_state.tier1);
-        tier_free(&t9plus_state.tier2);
-        tier_free(&t9plus_state.tier3a);
-        return false;
+    result_cache_clear();
+}
+
+// Helper: Continue a trie walk at depth along prefix[from, len), spending one visit per step
+static TriePos fuzzy_walk(
+    const LexiconPart* part,
+    TriePos pos,
+    size_t depth,
+    const char* prefix,
+    size_t from,
+    size_t len,
+    uint16_t* budget
+) {
+    for(size_t i = from; i < len && pos.node != T9LEX_NONE; i++) {
+        if(*budget == 0) return (TriePos){.node = T9LEX_NONE, .end = 0};
+        (*budget)--;
+        pos = trie_step(part, pos, depth++, prefix[i]);
     }
-    if(!tier_alloc(&t9plus_state.tier4, MAX_TIER_WORDS)) {
-        FURI_LOG_E(TAG, "Failed to allocate tier4");
-        tier_free(&t9plus_state.tier1);
-        tier_free(&t9plus_state.tier2);
-        tier_free(&t9plus_state.tier3a);
-        tier_free(&t9plus_state.tier3b);
-        return false;
+    return pos;
+}
+
+// Helper: Offer the completions of a part's trie position to a top-K list, if it is alive
+static void fuzzy_offer(TopK* top, const LexiconPart* part, TriePos pos) {
+    if(pos.node != T9LEX_NONE) topk_add_node(top, part, &part->nodes[pos.node]);
+}
+
+// Helper: Offer the completions of the prefixes one slip away from a lowercase prefix in a part.
+// The slip may be at any position the prefix exists up to; the rest must then match exactly.
+static void fuzzy_add_part(
+    TopK* top,
+    const LexiconPart* part,
+    const char* prefix,
+    size_t prefix_len,
+    uint16_t* budget
+) {
+    TriePos pos = trie_root;
+    for(size_t i = 0; i < prefix_len && pos.node != T9LEX_NONE && *budget > 0; i++) {
+        // A neighbouring key in place of prefix[i]
+        const char* neighbors = (unsigned char)prefix[i] < FUZZY_KEY_COUNT ?
+            t9plus_state.key_neighbors[(unsigned char)prefix[i]] : "";
+        for(size_t n = 0; n < FUZZY_NEIGHBORS && neighbors[n] != '\0'; n++) {
+            TriePos slip = fuzzy_walk(part, pos, i, neighbors, n, n + 1, budget);
+            fuzzy_offer(top, part, fuzzy_walk(part, slip, i + 1, prefix, i + 1, prefix_len, budget));
+        }
+        // prefix[i] pressed twice
+        if(i > 0 && prefix[i] == prefix[i - 1]) {
+            fuzzy_offer(top, part, fuzzy_walk(part, pos, i, prefix, i + 1, prefix_len, budget));
+        }
+        pos = fuzzy_walk(part, pos, i, prefix, i, i + 1, budget);
     }
+}
+
+// Helper: Fill the suggestion slots left by the exact lookups with completions of the
+// prefixes one slip away, skipping words already suggested
+static uint8_t fuzzy_suggest(
+    const char* prefix,
+    size_t prefix_len,
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    uint8_t found,
+    uint8_t max_suggestions
+) {
+    if(found >= max_suggestions || prefix_len < FUZZY_MIN_PREFIX) return found;
     
-    // Load tier files
-    bool all_loaded = true;
-    int failed_count = 0;
-    
-    if(!load_tier_from_file("/ext/apps_data/type_aid/data/tier1_function_words.txt", &t9plus_state.tier1)) {
-        all_loaded = false;
-        failed_count++;
-    }
-    if(!load_tier_from_file("/ext/apps_data/type_aid/data/tier2_lemma_list.txt", &t9plus_state.tier2)) {
-        all_loaded = false;
-        failed_count++;
+    TopK top = {0};
+    uint16_t budget = FUZZY_MAX_VISITS;
+    for(size_t p = 0; p < T9LEX_PART_COUNT; p++) {
+        const LexiconPart* part = &t9plus_state.parts[p];
+        if(part_is_ready(part)) fuzzy_add_part(&top, part, prefix, prefix_len, &budget);
     }
-    if(!load_tier_from_file("/ext/apps_data/type_aid/data/tier3a_chat.txt", &t9plus_state.tier3a)) {
-        all_loaded = false;
-        failed_count++;
+    STATS_ADD(fuzzy_searches, 1);
+    if(budget == 0) {
+        STATS_ADD(fuzzy_budget_exhausted, 1);
+        T9PLUS_LOG_T(TAG, "Fuzzy search for '%.*s' ran out of budget", (int)prefix_len, prefix);
     }
-    if(!load_tier_from_file("/ext/apps_data/type_aid/data/tier3b_fillers.txt", &t9plus_state.tier3b)) {
-        all_loaded = false;
-        failed_count++;
+    return copy_top_suggestions(&top, suggestions, found, max_suggestions);
+}
+
+// ============================================================================
+// RESULT CACHE
+// ============================================================================
+
+// Helper: Build the result cache key of a lookup. The previous word only matters for
+// next-word predictions, and only as the bigram table sees it.
+static void result_key_init(
+    ResultKey* key,
+    const char* prefix,
+    size_t prefix_len,
+    const char* prev,
+    const GateContext* gate
+) {
+    memset(key, 0, sizeof(*key));
+    memcpy(key->prefix, prefix, prefix_len);
+    char prev_key[T9BG_WORD_SIZE];
+    if(prefix_len == 0 && word_key(prev, prev_key, sizeof(prev_key))) {
+        memcpy(key->prev, prev_key, sizeof(prev_key));
     }
-    if(!load_tier_from_file("/ext/apps_data/type_aid/data/tier4_formal_discourse.txt", &t9plus_state.tier4)) {
-        all_loaded = false;
-        failed_count++;
+    memcpy(&key->gate, gate, sizeof(key->gate));
+    for(size_t p = 0; p < T9LEX_PART_COUNT; p++) {
+        if(part_is_ready(&t9plus_state.parts[p])) key->ready |= 1 << p;
     }
-    
-    // TEMPORARY: Add hardcoded test words if files didn't load
-    if(t9plus_state.tier1.count == 0) {
-        FURI_LOG_W(TAG, "Tier1 empty, adding hardcoded test words");
-        tier_add_word(&t9plus_state.tier1, "the");
-        tier_add_word(&t9plus_state.tier1, "that");
-        tier_add_word(&t9plus_state.tier1, "this");
-        tier_add_word(&t9plus_state.tier1, "to");
-        tier_add_word(&t9plus_state.tier1, "it");
-        tier_add_word(&t9plus_state.tier1, "is");
-        tier_add_word(&t9plus_state.tier1, "in");
-        tier_add_word(&t9plus_state.tier1, "and");
-        tier_add_word(&t9plus_state.tier1, "have");
-        tier_add_word(&t9plus_state.tier1, "we");
-        tier_add_word(&t9plus_state.tier1, "were");
-        tier_add_word(&t9plus_state.tier1, "will");
-        tier_add_word(&t9plus_state.tier1, "would");
-        tier_add_word(&t9plus_state.tier1, "hello");
-        tier_add_word(&t9plus_state.tier1, "help");
-        tier_add_word(&t9plus_state.tier1, "world");
-        tier_add_word(&t9plus_state.tier1, "work");
-        FURI_LOG_I(TAG, "Added %zu hardcoded words to tier1", t9plus_state.tier1.count);
-    }
-    
-    // Set error message if files failed to load
-    if(!all_loaded) {
-        t9plus_state.has_load_errors = true;
-        if(failed_count == 5) {
-            snprintf(t9plus_state.error_message, sizeof(t9plus_state.error_message), 
-                "ERROR: No data files found!");
-        } else {
-            snprintf(t9plus_state.error_message, sizeof(t9plus_state.error_message), 
-                "WARNING: %d data file(s) missing", failed_count);
-        }
-        FURI_LOG_W(TAG, "%s", t9plus_state.error_message);
-    } else {
-        t9plus_state.has_load_errors = false;
-        t9plus_state.error_message[0] = '\0';
+    if(loader_published(&t9plus_state.user_ready)) key->ready |= 1 << T9LEX_PART_COUNT;
+}
+
+// Helper: FNV-1a hash of a result cache key
+static uint32_t result_key_hash(const ResultKey* key) {
+    const uint8_t* bytes = (const uint8_t*)key;
+    uint32_t hash = 2166136261UL;
+    for(size_t i = 0; i < sizeof(*key); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619UL;
     }
-    
-    FURI_LOG_I(TAG, "Loaded words: tier1=%zu, tier2=%zu, tier3a=%zu, tier3b=%zu, tier4=%zu",
-        t9plus_state.tier1.count,
-        t9plus_state.tier2.count,
-        t9plus_state.tier3a.count,
-        t9plus_state.tier3b.count,
-        t9plus_state.tier4.count);
-    
-    t9plus_state.initialized = true;
-    return true;
+    return hash;
 }
 
-void t9plus_deinit(void) {
-    if(!t9plus_state.initialized) return;
-    
-    FURI_LOG_I(TAG, "Shutting down T9+");
-    
-    tier_free(&t9plus_state.tier1);
-    tier_free(&t9plus_state.tier2);
-    tier_free(&t9plus_state.tier3a);
-    tier_free(&t9plus_state.tier3b);
-    tier_free(&t9plus_state.tier4);
-    
-    t9plus_state.initialized = false;
+// Helper: Find the cached results of a key, NULL on a miss
+static ResultCacheSlot* result_cache_get(const ResultKey* key, uint32_t hash) {
+    for(size_t i = 0; i < RESULT_CACHE_SLOTS; i++) {
+        ResultCacheSlot* slot = &t9plus_state.result_cache[i];
+        if(!slot->last_used || slot->hash != hash || memcmp(&slot->key, key, sizeof(*key)) != 0) continue;
+        slot->last_used = ++t9plus_state.result_clock;
+        STATS_ADD(result_cache_hits, 1);
+        return slot;
+    }
+    STATS_ADD(result_cache_misses, 1);
+    return NULL;
 }
 
-bool t9plus_is_word_char(char c) {
-    return isalnum((unsigned char)c) || c == '\'';
+// Helper: FNV-1a hash of a list of suggestions, the same for the same words in the same order
+static uint32_t result_generation(
+    const char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    const uint8_t* lengths,
+    uint8_t count
+) {
+    uint32_t hash = 2166136261UL;
+    for(uint8_t i = 0; i < count; i++) {
+        // Each word with its NUL, so the word boundaries count too
+        for(uint8_t j = 0; j <= lengths[i]; j++) {
+            hash ^= (uint8_t)suggestions[i][j];
+            hash *= 16777619UL;
+        }
+    }
+    return hash;
 }
 
-const char* t9plus_get_error_message(void) {
-    if(!t9plus_state.initialized) {
-        return "T9+ not initialized";
+// Helper: The least recently used cache slot, which a missed lookup computes into. The slot
+// of the last list handed out is never picked, even once cleared, as the GUI thread may still
+// be drawing its words.
+static ResultCacheSlot* result_cache_victim(void) {
+    ResultCacheSlot* victim = NULL;
+    for(size_t i = 0; i < RESULT_CACHE_SLOTS; i++) {
+        ResultCacheSlot* slot = &t9plus_state.result_cache[i];
+        if(slot == t9plus_state.result_listed) continue;
+        if(!victim || slot->last_used < victim->last_used) victim = slot;
     }
-    
-    if(t9plus_state.has_load_errors) {
-        return t9plus_state.error_message;
+    return victim;
+}
+
+// Helper: Make the results computed into a slot a cache entry of a key
+static void result_cache_put(ResultCacheSlot* slot, const ResultKey* key, uint32_t hash) {
+    memcpy(&slot->key, key, sizeof(*key));
+    slot->hash = hash;
+    for(uint8_t i = 0; i < slot->count; i++) {
+        slot->lengths[i] = strlen(slot->suggestions[i]);
     }
-    
-    return NULL;  // No error
+    slot->generation = result_generation(slot->suggestions, slot->lengths, slot->count);
+    slot->last_used = ++t9plus_state.result_clock;
 }
 
-// Helper: Case-insensitive prefix match
-static bool starts_with_ci(const char* word, const char* prefix) {
-    size_t prefix_len = strlen(prefix);
-    size_t word_len = strlen(word);
-    
-    if(word_len < prefix_len) {
-        return false;
+// Helper: Compute the suggestions for a lowercase prefix, or for the word after prev while the
+// prefix is empty.
+static uint8_t suggest_compute(
+    const char* prefix,
+    size_t prefix_len,
+    const char* prev,
+    const GateContext* gate,
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    uint8_t max_suggestions
+) {
+    if(prefix_len == 0) {
+        return suggest_next_word(prev, gate, suggestions, max_suggestions);
     }
     
-    for(size_t i = 0; i < prefix_len; i++) {
-        char w = tolower((unsigned char)word[i]);
-        char p = tolower((unsigned char)prefix[i]);
-        if(w != p) {
-            return false;
+    // The best completions of the prefix are cached at its trie node in each part;
+    // merge them by score. The deferred part is skipped until it has been loaded.
+    TopK top = {0};
+    for(size_t p = 0; p < T9LEX_PART_COUNT; p++) {
+        const LexiconPart* part = &t9plus_state.parts[p];
+        if(!part_is_ready(part)) continue;
+        const T9LexNode* node = trie_find(part, prefix, prefix_len);
+        if(node) {
+            topk_add_node(&top, part, node);
+        } else {
+            T9PLUS_LOG_T(TAG, "No word in part %zu starts with '%.*s'", p, (int)prefix_len, prefix);
         }
     }
+    topk_add_frames(&top, gate, prefix, prefix_len);
+    uint8_t found = user_suggest(prefix, prefix_len, suggestions, max_suggestions);
+    found = copy_top_suggestions(&top, suggestions, found, max_suggestions);
+    found = dict_suggest(prefix, prefix_len, suggestions, found, max_suggestions);
+    return fuzzy_suggest(prefix, prefix_len, suggestions, found, max_suggestions);
+}
+
+// Helper: The cache slot holding the complete suggestions of a lookup, see suggest_compute().
+// A hit needs no trie, frame or dictionary access; a miss computes into the slot it reuses.
+static const ResultCacheSlot* suggest_word_cached(
+    const char* prefix,
+    size_t prefix_len,
+    const char* prev,
+    const GateContext* gate
+) {
+    ResultKey key;
+    result_key_init(&key, prefix, prefix_len, prev, gate);
+    uint32_t hash = result_key_hash(&key);
+    ResultCacheSlot* slot = result_cache_get(&key, hash);
+    if(slot) {
+        T9PLUS_LOG_T(TAG, "Result cache hit for '%.*s'", (int)prefix_len, prefix);
+        return slot;
+    }
     
-    return true;
+    slot = result_cache_victim();
+    slot->count = suggest_compute(
+        prefix, prefix_len, prev, gate, slot->suggestions, T9PLUS_MAX_SUGGESTIONS);
+    result_cache_put(slot, &key, hash);
+    return slot;
 }
 
-// Helper: Search tier for matches
-static void search_tier(
-    const WordTier* tier,
+// Helper: Copy the suggestions of a lookup, through the result cache
+static uint8_t suggest_word(
     const char* prefix,
+    size_t prefix_len,
+    const char* prev,
+    const GateContext* gate,
     char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
-    uint8_t* found_count,
     uint8_t max_suggestions
 ) {
-    FURI_LOG_I(TAG, "search_tier: searching %zu words for prefix '%s'", tier->count, prefix);
-    size_t matches_in_tier = 0;
-    
-    for(size_t i = 0; i < tier->count && *found_count < max_suggestions; i++) {
-        if(starts_with_ci(tier->words[i], prefix)) {
-            FURI_LOG_I(TAG, "  MATCH: '%s' matches '%s'", tier->words[i], prefix);
-            strncpy(suggestions[*found_count], tier->words[i], T9PLUS_MAX_WORD_LENGTH - 1);
-            suggestions[*found_count][T9PLUS_MAX_WORD_LENGTH - 1] = '\0';
-            (*found_count)++;
-            matches_in_tier++;
-        }
-    }
-    
-    if(matches_in_tier > 0) {
-        FURI_LOG_I(TAG, "search_tier: found %zu matches", matches_in_tier);
-    } else {
-        FURI_LOG_I(TAG, "search_tier: no matches found");
+    // Only complete result lists are cached
+    if(max_suggestions != T9PLUS_MAX_SUGGESTIONS) {
+        return suggest_compute(prefix, prefix_len, prev, gate, suggestions, max_suggestions);
     }
+    const ResultCacheSlot* slot = suggest_word_cached(prefix, prefix_len, prev, gate);
+    memcpy(suggestions, slot->suggestions, slot->count * T9PLUS_MAX_WORD_LENGTH);
+    return slot->count;
 }
 
-uint8_t t9plus_get_suggestions(
+// Helper: Suggestions for the last word of input, see t9plus_get_suggestions()
+static uint8_t suggest_for_input(
     const char* input,
     char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
     uint8_t max_suggestions
 ) {
-    FURI_LOG_I(TAG, "=== get_suggestions called ===");
-    FURI_LOG_I(TAG, "Input buffer: '%s'", input ? input : "(null)");
+    T9PLUS_LOG_T(TAG, "=== get_suggestions called ===");
+    T9PLUS_LOG_T(TAG, "Input buffer: '%s'", input ? input : "(null)");
     
     if(!t9plus_state.initialized) {
         FURI_LOG_W(TAG, "Not initialized!");
@@ -335,7 +3029,7 @@ uint8_t t9plus_get_suggestions(
     }
     
     if(!input || strlen(input) == 0) {
-        FURI_LOG_I(TAG, "Empty input, returning 0");
+        T9PLUS_LOG_T(TAG, "Empty input, returning 0");
         return 0;
     }
     
@@ -347,7 +3041,11 @@ uint8_t t9plus_get_suggestions(
     const char* last_word_start = input;
     size_t input_len = strlen(input);
     
-    FURI_LOG_I(TAG, "Input length: %zu", input_len);
+    // After a space, predict the word following the last one instead of completing it
+    char last_char = input[input_len - 1];
+    bool next_word = last_char == ' ' || last_char == '\n' || last_char == '\r';
+    
+    T9PLUS_LOG_T(TAG, "Input length: %zu", input_len);
     
     // Scan backwards from end to find last word boundary
     if(input_len > 0) {
@@ -368,7 +3066,7 @@ uint8_t t9plus_get_suggestions(
         
         // Check if we have a valid word
         if(last_word_start >= word_end) {
-            FURI_LOG_I(TAG, "No word found in input");
+            T9PLUS_LOG_T(TAG, "No word found in input");
             return 0;
         }
     }
@@ -378,58 +3076,302 @@ uint8_t t9plus_get_suggestions(
     size_t word_len = 0;
     const char* p = last_word_start;
     while(*p && *p != ' ' && *p != '\n' && *p != '\r' && word_len < MAX_WORD_LEN - 1) {
-        last_word[word_len++] = *p++;
+        last_word[word_len++] = tolower((unsigned char)*p++);
     }
     last_word[word_len] = '\0';
     
     // Skip if last word is empty
     if(word_len == 0) {
-        FURI_LOG_I(TAG, "Extracted word is empty");
+        T9PLUS_LOG_T(TAG, "Extracted word is empty");
         return 0;
     }
     
-    FURI_LOG_I(TAG, "Searching for prefix: '%s' (length: %zu)", last_word, word_len);
-    FURI_LOG_I(TAG, "Tier sizes: tier1=%zu, tier2=%zu, tier3a=%zu, tier3b=%zu, tier4=%zu",
-        t9plus_state.tier1.count,
-        t9plus_state.tier2.count,
-        t9plus_state.tier3a.count,
-        t9plus_state.tier3b.count,
-        t9plus_state.tier4.count);
+    // The buffer carries no context for the frames
+    static const GateContext no_context = {0};
+    uint8_t found;
+    if(next_word) {
+        T9PLUS_LOG_T(TAG, "Predicting the word after: '%s'", last_word);
+        found = suggest_word("", 0, last_word, &no_context, suggestions, max_suggestions);
+    } else {
+        T9PLUS_LOG_T(TAG, "Searching for prefix: '%s' (length: %zu)", last_word, word_len);
+        found = suggest_word(last_word, word_len, "", &no_context, suggestions, max_suggestions);
+    }
     
-    uint8_t found = 0;
+    T9PLUS_LOG_T(TAG, "=== Returning %d suggestions ===", found);
+    return found;
+}
+
+uint8_t t9plus_get_suggestions(
+    const char* input,
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    uint8_t max_suggestions
+) {
+    uint32_t start = stats_cycles();
+    uint8_t found = suggest_for_input(input, suggestions, max_suggestions);
+    stats_record_lookup(start);
+    return found;
+}
+
+// ============================================================================
+// TYPING CONTEXT
+// ============================================================================
+
+// Helper: Whether a character ends a sentence
+static inline bool context_is_sentence_end(char c) {
+    return c == '.' || c == '!' || c == '?';
+}
+
+// Helper: Make the current word of a context its previous word
+static void context_finish_word(T9PlusContext* ctx) {
+    if(ctx->word_len == 0) return;
+    
+    memcpy(ctx->last_token, ctx->word, sizeof(ctx->last_token));
+    memmove(&ctx->token_sets[1], &ctx->token_sets[0], (T9PLUS_CONTEXT_HISTORY - 1) * sizeof(ctx->token_sets[0]));
+    ctx->token_sets[0] = frames_word_sets(ctx->last_token);
+    if(ctx->sentence_len < UINT8_MAX) ctx->sentence_len++;
+    if(ctx->sentence_len == 1) {
+        ctx->is_question = (ctx->token_sets[0] & t9plus_state.frame_question_sets) != 0;
+    }
+    ctx->punct = '\0';
+    ctx->word[0] = '\0';
+    ctx->word_len = 0;
+}
+
+// Helper: Gating context of a typing context
+static void context_gate(const T9PlusContext* ctx, GateContext* gate) {
+    memcpy(gate->tokens, ctx->token_sets, sizeof(gate->tokens));
+    const char* mark = ctx->punct ? strchr(frame_punct, ctx->punct) : NULL;
+    gate->punct = mark ? 1 << (mark - frame_punct) : 0;
+    gate->register_bit = 0;
+    gate->sentence_len = ctx->sentence_len;
+    gate->is_question = ctx->is_question;
+}
+
+void t9plus_context_reset(T9PlusContext* ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void t9plus_context_push_char(T9PlusContext* ctx, char c) {
+    if(t9plus_is_word_char(c)) {
+        if(ctx->word_len < MAX_WORD_LEN - 1) {
+            ctx->word[ctx->word_len] = tolower((unsigned char)c);
+            ctx->word[ctx->word_len + 1] = '\0';
+        }
+        if(ctx->word_len < UINT16_MAX) ctx->word_len++;
+        return;
+    }
     
-    // Search tiers in priority order: tier1, tier3a, tier3b, tier2, tier4
-    FURI_LOG_I(TAG, "Searching tier1...");
-    search_tier(&t9plus_state.tier1, last_word, suggestions, &found, max_suggestions);
-    FURI_LOG_I(TAG, "After tier1: found=%d", found);
+    context_finish_word(ctx);
+    if(c != '\0' && strchr(frame_punct, c)) {
+        ctx->punct = c;
+    }
+    if(context_is_sentence_end(c)) {
+        ctx->sentence_len = 0;
+        ctx->is_question = false;
+    }
+}
+
+void t9plus_context_pop_char(T9PlusContext* ctx, const char* text, size_t text_len) {
+    if(ctx->word_len == 0) {
+        // A word or sentence boundary was removed
+        t9plus_context_rebuild(ctx, text, text_len);
+        return;
+    }
+    ctx->word_len--;
+    if(ctx->word_len < MAX_WORD_LEN - 1) {
+        ctx->word[ctx->word_len] = '\0';
+    }
+}
+
+void t9plus_context_set_word(T9PlusContext* ctx, const char* word) {
+    ctx->word[0] = '\0';
+    ctx->word_len = 0;
+    while(*word) {
+        if(ctx->word_len < MAX_WORD_LEN - 1) {
+            ctx->word[ctx->word_len] = tolower((unsigned char)*word);
+            ctx->word[ctx->word_len + 1] = '\0';
+        }
+        if(ctx->word_len < UINT16_MAX) ctx->word_len++;
+        word++;
+    }
+}
+
+void t9plus_context_rebuild(T9PlusContext* ctx, const char* text, size_t text_len) {
+    // The previous sentence supplies the words and the punctuation before the current one.
+    // Only the last words matter: the history, enough finished words to reach every gate's
+    // sentence length, and the current word, so the scan stops there however long the text.
+    size_t max_words = T9PLUS_CONTEXT_HISTORY + t9plus_state.frame_max_sentence_len + 1;
+    size_t words = 0;
+    size_t start = text_len;
+    uint8_t sentence_ends = 0;
+    while(start > 0) {
+        char c = text[start - 1];
+        if(context_is_sentence_end(c) && ++sentence_ends == 2) break;
+        // Stop right after a word, so the replay starts at a boundary
+        if(t9plus_is_word_char(c) && (start == text_len || !t9plus_is_word_char(text[start])) &&
+           ++words > max_words) {
+            break;
+        }
+        start--;
+    }
     
-    if(found < max_suggestions) {
-        FURI_LOG_I(TAG, "Searching tier3a...");
-        search_tier(&t9plus_state.tier3a, last_word, suggestions, &found, max_suggestions);
-        FURI_LOG_I(TAG, "After tier3a: found=%d", found);
+    // Without the start of the sentence in the replay, its question flag is the one the
+    // context had; sentence_len already reaches every gate's length
+    bool is_question = ctx->is_question;
+    bool sentence_cut = start > 0 && sentence_ends == 0;
+    t9plus_context_reset(ctx);
+    for(size_t i = start; i < text_len; i++) {
+        t9plus_context_push_char(ctx, text[i]);
     }
-    if(found < max_suggestions) {
-        FURI_LOG_I(TAG, "Searching tier3b...");
-        search_tier(&t9plus_state.tier3b, last_word, suggestions, &found, max_suggestions);
-        FURI_LOG_I(TAG, "After tier3b: found=%d", found);
+    if(sentence_cut) {
+        ctx->is_question = is_question;
     }
-    if(found < max_suggestions) {
-        FURI_LOG_I(TAG, "Searching tier2...");
-        search_tier(&t9plus_state.tier2, last_word, suggestions, &found, max_suggestions);
-        FURI_LOG_I(TAG, "After tier2: found=%d", found);
+}
+
+// Helper: Gating context and previous word of a lookup for a context, false if it has no suggestions
+static bool context_lookup(const T9PlusContext* ctx, GateContext* gate, const char** prev) {
+    if(!t9plus_state.initialized) {
+        return false;
     }
-    if(found < max_suggestions) {
-        FURI_LOG_I(TAG, "Searching tier4...");
-        search_tier(&t9plus_state.tier4, last_word, suggestions, &found, max_suggestions);
-        FURI_LOG_I(TAG, "After tier4: found=%d", found);
+    
+    // Longer than any word in the lexicon
+    if(ctx->word_len >= MAX_WORD_LEN) {
+        return false;
     }
     
-    FURI_LOG_I(TAG, "=== Returning %d suggestions ===", found);
-    if(found > 0) {
-        for(uint8_t i = 0; i < found; i++) {
-            FURI_LOG_I(TAG, "  Suggestion %d: '%s'", i, suggestions[i]);
-        }
+    context_gate(ctx, gate);
+    // An empty word is predicted from the previous word only within a sentence
+    *prev = ctx->sentence_len > 0 ? ctx->last_token : "";
+    return true;
+}
+
+// Helper: Suggestions for the current word of a context, see t9plus_get_suggestions_ctx()
+static uint8_t suggest_for_context(
+    const T9PlusContext* ctx,
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    uint8_t max_suggestions
+) {
+    GateContext gate;
+    const char* prev;
+    if(!context_lookup(ctx, &gate, &prev)) {
+        return 0;
     }
     
+    if(max_suggestions > T9PLUS_MAX_SUGGESTIONS) {
+        max_suggestions = T9PLUS_MAX_SUGGESTIONS;
+    }
+    return suggest_word(ctx->word, ctx->word_len, prev, &gate, suggestions, max_suggestions);
+}
+
+uint8_t t9plus_get_suggestions_ctx(
+    const T9PlusContext* ctx,
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    uint8_t max_suggestions
+) {
+    uint32_t start = stats_cycles();
+    uint8_t found = suggest_for_context(ctx, suggestions, max_suggestions);
+    stats_record_lookup(start);
     return found;
-}
\ No newline at end of file
+}
+
+void t9plus_get_suggestion_list_ctx(const T9PlusContext* ctx, T9PlusSuggestionList* list) {
+    uint32_t start = stats_cycles();
+    GateContext gate;
+    const char* prev;
+    if(context_lookup(ctx, &gate, &prev)) {
+        // The list points into the slot, which no lookup reuses before the next list
+        const ResultCacheSlot* slot = suggest_word_cached(ctx->word, ctx->word_len, prev, &gate);
+        t9plus_state.result_listed = slot;
+        for(uint8_t i = 0; i < slot->count; i++) {
+            list->items[i].word = slot->suggestions[i];
+            list->items[i].length = slot->lengths[i];
+        }
+        list->count = slot->count;
+        list->generation = slot->generation;
+    } else {
+        list->count = 0;
+        list->generation = result_generation(NULL, NULL, 0);
+    }
+    stats_record_lookup(start);
+}
+
+// ============================================================================
+// LEARNING
+// ============================================================================
+
+void t9plus_learn_word(const char* word, bool accepted) {
+    if(!t9plus_state.initialized || !loader_published(&t9plus_state.user_ready)) return;
+    
+    char key[USER_WORD_SIZE];
+    if(!user_word_key(word, key)) return;
+    
+    uint16_t weight = accepted ? USER_ACCEPTED_WEIGHT : USER_TYPED_WEIGHT;
+    bool capitalized = isupper((unsigned char)word[0]);
+    user_add(key, weight, capitalized);
+    result_cache_clear();
+    T9PLUS_LOG_T(TAG, "Learned '%s' (+%u)", key, weight);
+    
+    // One small append per learn; the log is rewritten only once it has grown enough
+    if(!user_log_append(key, weight, capitalized)) {
+        FURI_LOG_W(TAG, "Could not append to %s", T9PLUS_USER_WORDS_PATH);
+        return;
+    }
+    t9plus_state.user_log_lines++;
+    if(t9plus_state.user_log_lines > t9plus_state.user_count + USER_COMPACT_SLACK) {
+        user_compact();
+    }
+}
+
+#if T9PLUS_STATS
+const T9PlusStats* t9plus_get_stats(void) {
+    return &t9plus_state.stats;
+}
+
+// Helper: Average lookup time in microseconds
+static uint32_t stats_lookup_avg_us(const T9PlusStats* stats) {
+    if(stats->lookups == 0) return 0;
+    return stats->lookup_cycles_total / stats->lookups / furi_hal_cortex_instructions_per_microsecond();
+}
+
+void t9plus_stats_format(char* out, size_t out_size) {
+    const T9PlusStats* stats = &t9plus_state.stats;
+    uint32_t cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
+    snprintf(
+        out,
+        out_size,
+        "n%lu %lu/%lu/%luus",
+        (unsigned long)stats->lookups,
+        (unsigned long)(stats->lookups ? stats->lookup_cycles_min / cycles_per_us : 0),
+        (unsigned long)stats_lookup_avg_us(stats),
+        (unsigned long)(stats->lookup_cycles_max / cycles_per_us));
+}
+
+void t9plus_log_stats(void) {
+    const T9PlusStats* stats = &t9plus_state.stats;
+    FURI_LOG_I(TAG, "Stats: lexicon load %lu us, trie build %lu us",
+        (unsigned long)stats->lexicon_load_us,
+        (unsigned long)stats->trie_build_us);
+    FURI_LOG_I(TAG, "Stats: tier load us: tier1=%lu, tier2=%lu, tier3a=%lu, tier3b=%lu, tier4=%lu",
+        (unsigned long)stats->tier_load_us[0],
+        (unsigned long)stats->tier_load_us[1],
+        (unsigned long)stats->tier_load_us[2],
+        (unsigned long)stats->tier_load_us[3],
+        (unsigned long)stats->tier_load_us[4]);
+    FURI_LOG_I(TAG, "Stats: heap peak %zu bytes, resident %zu bytes", stats->heap_peak, stats->heap_resident);
+    FURI_LOG_I(TAG, "Stats: %lu lookups, cycles min=%lu avg=%lu max=%lu, avg %lu us",
+        (unsigned long)stats->lookups,
+        (unsigned long)stats->lookup_cycles_min,
+        (unsigned long)(stats->lookups ? stats->lookup_cycles_total / stats->lookups : 0),
+        (unsigned long)stats->lookup_cycles_max,
+        (unsigned long)stats_lookup_avg_us(stats));
+    FURI_LOG_I(TAG, "Stats: dictionary %lu block reads, %lu cache hits",
+        (unsigned long)stats->dict_block_reads,
+        (unsigned long)stats->dict_cache_hits);
+    FURI_LOG_I(TAG, "Stats: result cache %lu hits, %lu misses",
+        (unsigned long)stats->result_cache_hits,
+        (unsigned long)stats->result_cache_misses);
+    FURI_LOG_I(TAG, "Stats: %lu fuzzy searches, %lu out of budget",
+        (unsigned long)stats->fuzzy_searches,
+        (unsigned long)stats->fuzzy_budget_exhausted);
+}
+#endif
@@ -8,24 +8,85 @@
 // Maximum word length for suggestions
 #define T9PLUS_MAX_WORD_LENGTH 32
 
+// Per-keystroke trace logging. Set T9PLUS_TRACE=1 in the cdefines of application.fam
+// to enable it; otherwise these calls are compiled out completely.
+#ifndef T9PLUS_TRACE
+#define T9PLUS_TRACE 0
+#endif
+
+// Compile-time optional statistics (init timing, heap use, lookup cycles).
+// Set T9PLUS_STATS=1 in the cdefines of application.fam to enable them.
+#ifndef T9PLUS_STATS
+#define T9PLUS_STATS 0
+#endif
+
+// Number of vocabulary tiers: tier1, tier2, tier3a, tier3b, tier4
+#define T9PLUS_TIER_COUNT 5
+
+#if T9PLUS_TRACE
+#define T9PLUS_LOG_T(tag, ...) FURI_LOG_D(tag, __VA_ARGS__)
+#else
+#define T9PLUS_LOG_T(tag, ...) do { } while(0)
+#endif
+
 /**
  * @brief Initialize the T9+ prediction system
  * 
- * Loads vocabulary tiers from data files in the app's assets.
+ * Starts loading the vocabulary tiers from data files in the app's assets on a
+ * background thread and returns immediately. Until loading is done, lookups
+ * only search the tiers loaded so far (tier1, tier3a and tier3b come first).
  * Must be called before using any prediction functions.
  * 
  * @return true if initialization successful, false otherwise
  */
 bool t9plus_init(void);
 
+/**
+ * @brief Check whether suggestions are available yet
+ * 
+ * @return true once the primary tiers are loaded, or loading them failed
+ */
+bool t9plus_is_ready(void);
+
+/**
+ * @brief Get the progress of the background load
+ * 
+ * @return Percentage of the tiers loaded (0-100), 100 once loading is done
+ */
+uint8_t t9plus_get_load_progress(void);
+
+/**
+ * @brief Function called by the background load, see t9plus_set_load_callback()
+ * 
+ * @param context Context given to t9plus_set_load_callback()
+ */
+typedef void (*T9PlusLoadCallback)(void* context);
+
+/**
+ * @brief Set a function to call whenever the load makes progress
+ * 
+ * It runs on the loader thread each time t9plus_get_load_progress() or
+ * t9plus_is_ready() may have changed, so a caller can wait for it instead of
+ * polling. Set it before t9plus_init(); t9plus_deinit() clears it.
+ * 
+ * @param callback Function to call, NULL for none
+ * @param context Context passed to callback
+ */
+void t9plus_set_load_callback(T9PlusLoadCallback callback, void* context);
+
 /**
  * @brief Clean up and free resources used by T9+ system
+ * 
+ * Waits for a load still in progress to finish.
  */
 void t9plus_deinit(void);
 
 /**
  * @brief Get word suggestions based on current input
  * 
+ * Completes the last word of input, or predicts the next word when input ends
+ * with whitespace (e.g., "thank ").
+ * 
  * @param input Current partial word (e.g., "hel")
  * @param suggestions Array to store up to 3 suggestions (must be pre-allocated)
  * @param max_suggestions Maximum number of suggestions to return (typically 3)
@@ -37,6 +98,180 @@ uint8_t t9plus_get_suggestions(
     uint8_t max_suggestions
 );
 
+// Words of history kept by T9PlusContext, enough for the longest frame
+#define T9PLUS_CONTEXT_HISTORY 3
+
+/**
+ * @brief Typing context of the current word
+ * 
+ * Owned by the caller and kept up to date with the t9plus_context_*() calls as text is
+ * typed, so a lookup never rescans the text. Treat the fields as read-only.
+ */
+typedef struct {
+    char word[T9PLUS_MAX_WORD_LENGTH];       // Current partial word, lowercase
+    char last_token[T9PLUS_MAX_WORD_LENGTH]; // Word before it, lowercase, "" for none
+    uint32_t token_sets[T9PLUS_CONTEXT_HISTORY]; // Frame set masks of the previous words, most recent first
+    uint16_t word_len;    // Characters typed of the current word; only the first ones are stored
+    uint8_t sentence_len; // Words finished in the current sentence
+    char punct;           // Punctuation typed since the previous word ('.', ',', '!', '?', ':', ';'), or '\0'
+    bool is_question;     // The current sentence opened with a question word
+} T9PlusContext;
+
+/**
+ * @brief Clear a context, as at the start of an empty text
+ * 
+ * @param ctx Context to clear
+ */
+void t9plus_context_reset(T9PlusContext* ctx);
+
+/**
+ * @brief Update a context for a character appended to the text
+ * 
+ * @param ctx Context to update
+ * @param c Character appended
+ */
+void t9plus_context_push_char(T9PlusContext* ctx, char c);
+
+/**
+ * @brief Update a context for the last character removed from the text
+ * 
+ * Removing a character of the current word is O(1). Removing a space or punctuation
+ * rebuilds the context from the end of text, see t9plus_context_rebuild().
+ * 
+ * @param ctx Context to update
+ * @param text Text after the removal
+ * @param text_len Length of text
+ */
+void t9plus_context_pop_char(T9PlusContext* ctx, const char* text, size_t text_len);
+
+/**
+ * @brief Replace the current word of a context, e.g. after a suggestion was inserted
+ * 
+ * @param ctx Context to update
+ * @param word New current word (may be empty)
+ */
+void t9plus_context_set_word(T9PlusContext* ctx, const char* word);
+
+/**
+ * @brief Rebuild a context from the end of a text, e.g. after it was edited elsewhere
+ * 
+ * Replays at most the last two sentences of text, and only as many words of them as the
+ * context and the frame gates use, so the cost does not grow with the text. When the
+ * current sentence is longer than that, its question flag is kept from ctx.
+ * 
+ * @param ctx Context to rebuild
+ * @param text Text typed so far
+ * @param text_len Length of text
+ */
+void t9plus_context_rebuild(T9PlusContext* ctx, const char* text, size_t text_len);
+
+/**
+ * @brief Get word suggestions for the current word of a context
+ * 
+ * Completes the current word, or predicts it from the previous word while it is
+ * empty. Frames and gating rules boost candidates that fit the context. The cost
+ * does not depend on the length of the text.
+ * 
+ * @param ctx Context of the current word
+ * @param suggestions Array to store up to 3 suggestions (must be pre-allocated)
+ * @param max_suggestions Maximum number of suggestions to return (typically 3)
+ * @return Number of suggestions actually returned (0-3)
+ */
+uint8_t t9plus_get_suggestions_ctx(
+    const T9PlusContext* ctx,
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH],
+    uint8_t max_suggestions
+);
+
+/**
+ * @brief One suggestion of a T9PlusSuggestionList
+ */
+typedef struct {
+    const char* word; // NUL-terminated, owned by T9+
+    uint8_t length;   // strlen(word)
+} T9PlusSuggestion;
+
+/**
+ * @brief Suggestions returned without copying, see t9plus_get_suggestion_list_ctx()
+ */
+typedef struct {
+    T9PlusSuggestion items[T9PLUS_MAX_SUGGESTIONS];
+    uint8_t count;
+    uint32_t generation; // The same for the same words in the same order, so an unchanged list can be skipped
+} T9PlusSuggestionList;
+
+/**
+ * @brief Get word suggestions for the current word of a context without copying them
+ * 
+ * Like t9plus_get_suggestions_ctx() with 3 suggestions, but the list points at the
+ * words where T9+ keeps the results of recent lookups. The words stay valid and
+ * unchanged until the next call of this function or t9plus_deinit(); other lookups
+ * and t9plus_learn_word() leave them in place, so another thread may draw them meanwhile.
+ * 
+ * @param ctx Context of the current word
+ * @param list List to fill
+ */
+void t9plus_get_suggestion_list_ctx(const T9PlusContext* ctx, T9PlusSuggestionList* list);
+
+/**
+ * @brief Learn a word the user typed out in full or accepted as a suggestion
+ * 
+ * Learned words are suggested ahead of the built-in vocabulary once typed twice or
+ * accepted once, most used first. Each learn appends one line to a log in the app's data
+ * folder, which is compacted when it has grown and by t9plus_deinit().
+ * 
+ * @param word Word as typed, read up to the first character that is not a word character
+ * @param accepted true if the word was inserted from a suggestion
+ */
+void t9plus_learn_word(const char* word, bool accepted);
+
+/**
+ * @brief Get the number of language packs
+ * 
+ * @return Number of packs, whether installed or not
+ */
+uint8_t t9plus_get_language_count(void);
+
+/**
+ * @brief Get the short name of a language pack
+ * 
+ * @param language Pack index, less than t9plus_get_language_count()
+ * @return Name such as "en", or NULL for an invalid index
+ */
+const char* t9plus_get_language_name(uint8_t language);
+
+/**
+ * @brief Get the language pack in use
+ * 
+ * @return Pack index, 0 (the default pack) after start
+ */
+uint8_t t9plus_get_language(void);
+
+/**
+ * @brief Switch to another language pack
+ * 
+ * Releases the current pack and loads the new one in the background into the same memory,
+ * as t9plus_init() does, without restarting the system. Until it is loaded,
+ * t9plus_is_ready() is false. Learned words are shared by all packs.
+ * 
+ * @param language Pack index, less than t9plus_get_language_count()
+ * @return true if the pack is loading or already in use, false if it is not installed or
+ *         the previous load is still running
+ */
+bool t9plus_set_language(uint8_t language);
+
+/**
+ * @brief Set the keyboard layout used to tolerate typos
+ * 
+ * Keys next to each other within a line, or at the same position in adjacent lines, are
+ * neighbours. When a prefix has too few completions, suggestions also complete the
+ * prefixes with one key replaced by a neighbour or one key pressed twice.
+ * 
+ * @param lines Keys of each keyboard line, from top to bottom
+ * @param line_count Number of lines
+ */
+void t9plus_set_key_layout(const char* const* lines, size_t line_count);
+
 /**
  * @brief Check if a character is valid for word prediction
  * 
@@ -48,6 +283,46 @@ bool t9plus_is_word_char(char c);
 /**
  * @brief Get error message if files failed to load
  * 
- * @return Pointer to error message string, or NULL if no errors
+ * @return Pointer to error message string, or NULL if no errors or still loading
+ */
+const char* t9plus_get_error_message(void);
+
+#if T9PLUS_STATS
+typedef struct {
+    uint32_t lexicon_load_us;                 // Compiled lexicon reads, 0 if the text tiers were used
+    uint32_t tier_load_us[T9PLUS_TIER_COUNT]; // Text tier file parsing, 0 if the compiled lexicon was used
+    uint32_t trie_build_us;                   // Building the prefix indexes from the text tiers
+    size_t heap_peak;                         // Peak heap used while loading the lexicon, bytes
+    size_t heap_resident;                     // Heap held by the lexicon after init, bytes
+    uint32_t lookups;                         // Suggestion lookups since init
+    uint32_t lookup_cycles_min;               // CPU cycles (DWT_CYCCNT) per lookup
+    uint32_t lookup_cycles_max;
+    uint64_t lookup_cycles_total;
+    uint32_t dict_block_reads;                // Dictionary blocks read from the SD card
+    uint32_t dict_cache_hits;                 // Dictionary blocks found in the block cache
+    uint32_t result_cache_hits;               // Lookups answered from the result cache
+    uint32_t result_cache_misses;
+    uint32_t fuzzy_searches;                  // Lookups that searched for prefixes one slip away
+    uint32_t fuzzy_budget_exhausted;          // Fuzzy searches cut short by their visit budget
+} T9PlusStats;
+
+/**
+ * @brief Get the statistics collected since t9plus_init()
+ * 
+ * @return Pointer to the statistics block, valid until the next init
+ */
+const T9PlusStats* t9plus_get_stats(void);
+
+/**
+ * @brief Format lookup statistics as one short line for an on-screen overlay
+ * 
+ * @param out Output buffer
+ * @param out_size Size of the output buffer
+ */
+void t9plus_stats_format(char* out, size_t out_size);
+
+/**
+ * @brief Write all statistics to the log (also done by t9plus_deinit)
  */
-const char* t9plus_get_error_message(void);
\ No newline at end of file
+void t9plus_log_stats(void);
+#endif
@@ -0,0 +1,673 @@
+#!/usr/bin/env python3
+"""Compile the T9+ tier word lists into a binary lexicon, the bigram list
+into a next-word table, the frame and gating rules into fixed-point frame
+tables, and a large frequency-ordered word list into a block-indexed
+dictionary.
+
+The device reads each part of the lexicon (data/lexicon.t9l) into a single
+arena with one block read instead of parsing the plain-text tier files.
+The bigram table (data/bigrams.t9b, written next to the lexicon) stays on
+the SD card and is binary searched with seeks. The frame tables
+(data/frames.t9f) turn frames.tsv, frame_sets.tsv and gating_rules.tsv into
+set bitmasks and integer score scales, so the device never parses a rule.
+The dictionary (data/dictionary.t9d) is read from the SD card in 512-byte
+blocks through a small RAM index, so its size is not limited by RAM.
+The layouts must match the T9Lex*, T9Bigram*, T9Frame* and T9Dict*
+structures in t9plus.c.
+
+A language pack other than the default one is built from its own
+directory of source files into an output named after the pack, e.g.
+lexicon_de.t9l; the other output files get the same suffix.
+
+The fap build runs the script with --strict (see application.fam), so the
+compiled files always match their sources. --strict turns words and tiers
+the device would drop into errors, and checks the shared limits against
+t9plus.h and t9plus.c.
+
+Usage: build_lexicon.py [--strict] [DATA_DIR] [OUTPUT]
+"""
+
+import argparse
+import re
+import struct
+import sys
+from pathlib import Path
+
+MAGIC = 0x584C3954  # "T9LX"
+VERSION = 9
+
+# Rank fields: the position in the source file, the mask of the tiers listing the word and
+# a flag for a source word that started with an uppercase letter
+RANK_MASK = 0x03FF
+RANK_TIERS_SHIFT = 10
+RANK_CAPITALIZED = 0x8000
+
+# Limits shared with t9plus.c, and the #defines --strict checks them against
+MAX_WORD_LEN = 32
+MAX_TIER_WORDS = 1000
+SHARED_LIMITS = [
+    ("t9plus.h", "T9PLUS_MAX_WORD_LENGTH", MAX_WORD_LEN),
+    ("t9plus.c", "MAX_WORD_LEN", MAX_WORD_LEN),
+    ("t9plus.c", "MAX_TIER_WORDS", MAX_TIER_WORDS),
+]
+
+# FNV-1a parameters of the arena checksums, see lexicon_checksum() in t9plus.c
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+
+# Number of completions cached per trie node
+TOP_COUNT = 3
+NONE = 0xFFFF
+
+# Tier files in lexicon order: tier1, tier2, tier3a, tier3b, tier4
+TIER_FILES = [
+    "tier1_function_words.txt",
+    "tier2_lemma_list.txt",
+    "tier3a_chat.txt",
+    "tier3b_fillers.txt",
+    "tier4_formal_discourse.txt",
+]
+
+# Search priority of each tier, in lexicon order: tier1, tier3a, tier3b, tier2, tier4
+TIER_PRIORITY = [0, 3, 1, 2, 4]
+
+# Word scores, lower is better; see word_score() in t9plus.c
+UNIGRAM_FILE = "unigram_1000.txt"
+SCORE_UNIGRAM_STEP = 5
+SCORE_UNKNOWN = MAX_TIER_WORDS // SCORE_UNIGRAM_STEP
+SCORE_TIER_STEP = 4
+
+# Bigram table: fixed-size records sorted by previous word, each with the best next words
+BIGRAM_FILE = "bigrams.tsv"
+BIGRAM_OUTPUT = "bigrams.t9b"
+BIGRAM_MAGIC = 0x47423954  # "T9BG"
+BIGRAM_VERSION = 1
+BIGRAM_WORD_SIZE = 12  # NUL-padded word field, up to 11 characters
+BIGRAM_NEXT_COUNT = 3
+
+# Frame tables: gates, frames and the words of all token sets, see T9Frame* in t9plus.c
+FRAME_FILE = "frames.tsv"
+FRAME_SET_FILE = "frame_sets.tsv"
+GATE_FILE = "gating_rules.tsv"
+FRAME_OUTPUT = "frames.t9f"
+FRAME_MAGIC = 0x52463954  # "T9FR"
+FRAME_VERSION = 1
+FRAME_WORD_SIZE = 12
+FRAME_MAX_SLOTS = 4
+FRAME_MAX_SETS = 32  # Set bits of a uint32_t mask
+FRAME_SCALE_ONE = 256  # Score scale of boost 1.0, Q8
+GATE_ALWAYS = 0x01
+GATE_QUESTION = 0x02
+GATE_NO_SENTENCE_LEN = 0xFF
+# Registers and punctuation marks by bit, shared with t9plus.c
+FRAME_REGISTERS = ["chat", "casual", "formal"]
+FRAME_PUNCT = ".,!?:;"
+
+# Block-indexed dictionary, see T9Dict* in t9plus.c. Any frequency-ordered word list works;
+# the repo ships the unigram list.
+DICT_FILE = UNIGRAM_FILE
+DICT_OUTPUT = "dictionary.t9d"
+DICT_MAGIC = 0x58443954  # "T9DX"
+DICT_VERSION = 1
+DICT_BLOCK_SIZE = 512
+DICT_CLASSES = 28  # Character classes of the bucket index: below 'a', 'a'..'z', above 'z'
+DICT_BUCKETS = DICT_CLASSES * DICT_CLASSES  # Two-character buckets, then one per first character
+DICT_TOP_RECORDS = DICT_BUCKETS + DICT_CLASSES
+DICT_TOP_COUNT = 3
+DICT_TOP_SIZE = 16  # Three uint32_t refs and padding, so no record straddles a block
+DICT_NO_REF = 0xFFFFFFFF
+DICT_MAX_RANK = 0xFFFF
+DICT_CAPITALIZED = 0x80
+
+# Lexicon part of each tier: 0 = primary, loaded at init; 1 = deferred, loaded later
+TIER_PART = [0, 1, 0, 0, 1]
+PART_COUNT = 2
+
+
+# Set by --strict: fail on input the device would drop instead of warning
+strict = False
+
+
+def check_limits(source_dir):
+    """Fail if a limit shared with the device differs from its #define."""
+    for name, define, value in SHARED_LIMITS:
+        match = re.search(rf"^#define {define} (\d+)", (source_dir / name).read_text(), re.M)
+        if not match:
+            sys.exit(f"error: {name}: no #define {define}")
+        if int(match.group(1)) != value:
+            sys.exit(f"error: {name}: {define} is {match.group(1)}, this script assumes {value}")
+
+
+def read_tier(path, warn=True):
+    """Parse a tier file the same way the device's text loader does."""
+    words = []
+    for number, line in enumerate(path.read_bytes().replace(b"\r", b"\n").split(b"\n"), 1):
+        word = line.rstrip()
+        if not word or word.startswith(b"#"):
+            continue
+        # A suggestion holds T9PLUS_MAX_WORD_LENGTH - 1 characters
+        if strict and warn and len(word) >= MAX_WORD_LEN:
+            sys.exit(f"error: {path.name}:{number}: word longer than {MAX_WORD_LEN - 1} characters")
+        if len(line) > MAX_WORD_LEN:
+            continue
+        if len(words) == MAX_TIER_WORDS:
+            if strict and warn:
+                sys.exit(f"error: {path.name}: more than {MAX_TIER_WORDS} words")
+            if warn:
+                print(f"warning: {path.name}: more than {MAX_TIER_WORDS} words, rest dropped")
+            break
+        words.append(word)
+    return words
+
+
+def sort_tier(words):
+    """Lowercase and sort a tier; the rank keeps each word's position in its source file."""
+    ranked = []
+    for rank, word in enumerate(words):
+        flags = RANK_CAPITALIZED if word[:1].isupper() else 0
+        ranked.append((word.lower(), rank | flags))
+    ranked.sort(key=lambda item: (item[0], item[1] & ~RANK_CAPITALIZED))
+    return ranked
+
+
+def read_unigram(path):
+    """Map each lowercase word of the unigram list to its first position.
+
+    Like on the device, only the first MAX_TIER_WORDS lines count.
+    """
+    if not path.exists():
+        print(f"warning: {path.name} missing, ranking by tier only")
+        return {}
+    positions = {}
+    for position, word in enumerate(read_tier(path, warn=False)):
+        positions.setdefault(word.lower(), position)
+    return positions
+
+
+def score_tier(ranked, tier, unigram):
+    """Attach each word's one-byte score: unigram position, then tier priority."""
+    scored = []
+    for word, rank in ranked:
+        position = unigram.get(word, MAX_TIER_WORDS)
+        score = position // SCORE_UNIGRAM_STEP if position < MAX_TIER_WORDS else SCORE_UNKNOWN
+        score = min(255, score + TIER_PRIORITY[tier] * SCORE_TIER_STEP)
+        scored.append((word, rank, score))
+    return scored
+
+
+def dedupe_tiers(tiers):
+    """Keep each word once in the whole lexicon, in the listing tier of best priority.
+
+    The kept entry records every tier that listed the word in its rank, so the trie never
+    holds two entries for a word and its top completions are always distinct words.
+    """
+    home = {}  # Word -> tier of best priority, tier mask
+    for tier, scored in enumerate(tiers):
+        for word, _, _ in scored:
+            best, mask = home.get(word, (tier, 0))
+            if TIER_PRIORITY[tier] < TIER_PRIORITY[best]:
+                best = tier
+            home[word] = (best, mask | (1 << tier))
+
+    deduped = []
+    for tier, scored in enumerate(tiers):
+        kept = []
+        for word, rank, score in scored:
+            best, mask = home.get(word, (None, 0))
+            if best != tier:
+                continue  # Listed by a tier of better priority, or already kept
+            kept.append((word, rank | (mask << RANK_TIERS_SHIFT), score))
+            del home[word]
+        deduped.append(kept)
+    return deduped
+
+
+def build_trie(tiers):
+    """Build the path-compressed trie breadth first, mirroring trie_build() in t9plus.c.
+
+    Returns packed nodes. Entry refs number the words of the given tiers consecutively.
+    """
+    entries = []  # (word, key, ref)
+    ref = 0
+    for tier, ranked in enumerate(tiers):
+        for word, rank, score in ranked:
+            key = entry_key(tier, rank, score)
+            entries.append((word, key, ref))
+            ref += 1
+    entries.sort(key=lambda entry: (entry[0], (entry[1] >> 16) & 0xFF))
+    if len(entries) >= NONE:
+        sys.exit("error: too many words for 16-bit entry refs")
+
+    nodes = [[0, 0, 0, 0, []]]  # label_ref, label_len, child_count, first_child, top
+    ranges = [(0, len(entries), 0)]
+    n = 0
+    while n < len(nodes):
+        lo, hi, depth = ranges[n]
+        node = nodes[n]
+        best = sorted(entries[lo:hi], key=lambda entry: entry[1])[:TOP_COUNT]
+        node[4] = [entry[2] for entry in best]
+        node[3] = len(nodes)
+
+        # Words ending at this node sort first, the rest is grouped by next character
+        i = lo
+        while i < hi and len(entries[i][0]) == depth:
+            i += 1
+        while i < hi:
+            first = entries[i][0]
+            j = i + 1
+            while j < hi and entries[j][0][depth] == first[depth]:
+                j += 1
+            last = entries[j - 1][0]
+            end = depth + 1
+            while end < len(first) and end < len(last) and first[end] == last[end]:
+                end += 1
+            nodes.append([entries[i][2], end - depth, 0, 0, []])
+            ranges.append((i, j, end))
+            node[2] += 1
+            i = j
+        n += 1
+
+    packed = b""
+    for label_ref, label_len, child_count, first_child, top in nodes:
+        top = top + [NONE] * (TOP_COUNT - len(top))
+        packed += struct.pack(f"<HBBH{TOP_COUNT}H", label_ref, label_len, child_count, first_child, *top)
+    return packed, len(nodes)
+
+
+def entry_key(tier, rank, score):
+    """Ordering key of an entry, as entry_key() in t9plus.c: score, tier priority, rank."""
+    return (score << 24) | (TIER_PRIORITY[tier] << 16) | (rank & RANK_MASK)
+
+
+def build_part(tiers):
+    """Lay out one part's arena; tiers of the other part are passed as empty lists."""
+    # Arena: tables, then per tier its uint16 word offsets and ranks and its uint8 scores
+    # followed by its words, then the uint32 ordering key of each entry ref, then the trie nodes.
+    entry_format = "<IIIII"
+    table_size = len(tiers) * struct.calcsize(entry_format) + struct.calcsize("<III")
+    body = b""
+    entries = []
+    for ranked in tiers:
+        if (table_size + len(body)) % 2:
+            body += b"\0"
+        packed = b""
+        offsets = []
+        for word, _, _ in ranked:
+            offsets.append(len(packed))
+            packed += word + b"\0"
+        if len(packed) > 0xFFFF:
+            sys.exit("error: tier exceeds 64 KiB of word data")
+        index_offset = table_size + len(body)
+        ranks_offset = index_offset + 2 * len(offsets)
+        scores_offset = ranks_offset + 2 * len(offsets)
+        words_offset = scores_offset + len(offsets)
+        entries.append(
+            struct.pack(entry_format, index_offset, ranks_offset, scores_offset, words_offset, len(ranked))
+        )
+        body += struct.pack(f"<{len(offsets)}H", *offsets)
+        body += struct.pack(f"<{len(ranked)}H", *(rank for _, rank, _ in ranked))
+        body += bytes(score for _, _, score in ranked)
+        body += packed
+
+    # Terminate the word data even if every tier is empty, then align the keys
+    body += b"\0"
+    while (table_size + len(body)) % 4:
+        body += b"\0"
+    keys_offset = table_size + len(body)
+    keys = [entry_key(tier, rank, score) for tier, ranked in enumerate(tiers) for _, rank, score in ranked]
+    body += struct.pack(f"<{len(keys)}I", *keys)
+    nodes, node_count = build_trie(tiers)
+    nodes_offset = table_size + len(body)
+
+    arena = b"".join(entries) + struct.pack("<III", nodes_offset, node_count, keys_offset) + body + nodes
+    return arena, node_count
+
+
+def fnv1a(data):
+    """32-bit FNV-1a hash of a byte string."""
+    value = FNV_OFFSET
+    for byte in data:
+        value = ((value ^ byte) * FNV_PRIME) & 0xFFFFFFFF
+    return value
+
+
+def build(data_dir):
+    unigram = read_unigram(data_dir / UNIGRAM_FILE)
+    tiers = dedupe_tiers([
+        score_tier(sort_tier(read_tier(data_dir / name)), tier, unigram)
+        for tier, name in enumerate(TIER_FILES)
+    ])
+
+    arenas = []
+    node_count = 0
+    for part in range(PART_COUNT):
+        part_tiers = [ranked if TIER_PART[t] == part else [] for t, ranked in enumerate(tiers)]
+        arena, nodes = build_part(part_tiers)
+        arenas.append(arena)
+        node_count += nodes
+    header = struct.pack(
+        f"<IHH{PART_COUNT}I{PART_COUNT}I",
+        MAGIC,
+        VERSION,
+        len(tiers),
+        *(len(arena) for arena in arenas),
+        *(fnv1a(arena) for arena in arenas),
+    )
+    return header + b"".join(arenas), tiers, node_count
+
+
+def build_bigrams(path):
+    """Compile "prev<TAB>next<TAB>score" lines into the sorted on-disk bigram table.
+
+    The previous word is matched lowercase; next words keep their case. Each previous
+    word keeps its BIGRAM_NEXT_COUNT best next words, highest score first.
+    """
+    table = {}
+    for number, line in enumerate(path.read_text().splitlines(), 1):
+        if not line.strip() or line.startswith("#"):
+            continue
+        fields = line.split("\t")
+        if len(fields) != 3:
+            sys.exit(f"error: {path.name}:{number}: expected prev, next and score")
+        prev, following, score = fields[0].strip().lower(), fields[1].strip(), int(fields[2])
+        if max(len(prev.encode()), len(following.encode())) >= BIGRAM_WORD_SIZE:
+            if strict:
+                sys.exit(f"error: {path.name}:{number}: word longer than {BIGRAM_WORD_SIZE - 1} characters")
+            print(f"warning: {path.name}:{number}: word longer than {BIGRAM_WORD_SIZE - 1} characters, skipped")
+            continue
+        candidates = table.setdefault(prev.encode(), [])
+        if all(existing != following.encode() for _, _, existing in candidates):
+            candidates.append((-score, len(candidates), following.encode()))
+
+    word = f"{BIGRAM_WORD_SIZE}s"
+    records = b""
+    for prev in sorted(table):
+        best = [following for _, _, following in sorted(table[prev])[:BIGRAM_NEXT_COUNT]]
+        best += [b""] * (BIGRAM_NEXT_COUNT - len(best))
+        records += struct.pack(f"<{word}{BIGRAM_NEXT_COUNT * word}", prev, *best)
+    record_size = BIGRAM_WORD_SIZE * (1 + BIGRAM_NEXT_COUNT)
+    header = struct.pack("<IHHI", BIGRAM_MAGIC, BIGRAM_VERSION, record_size, len(table))
+    return header + records, len(table)
+
+
+def read_tsv(path, columns):
+    """Yield (line number, fields) of the non-comment lines of a tab-separated file."""
+    for number, line in enumerate(path.read_text().splitlines(), 1):
+        if not line.strip() or line.startswith("#"):
+            continue
+        fields = [field.strip() for field in line.split("\t")]
+        if len(fields) != columns:
+            sys.exit(f"error: {path.name}:{number}: expected {columns} columns")
+        yield number, fields
+
+
+def parse_items(text):
+    """Items of a "{a,b,'c'}" condition literal."""
+    return [item.strip().strip("'\"") for item in text.strip("{}").split(",") if item.strip()]
+
+
+def register_mask(names, where):
+    mask = 0
+    for name in names:
+        if name not in FRAME_REGISTERS:
+            sys.exit(f"error: {where}: unknown register '{name}'")
+        mask |= 1 << FRAME_REGISTERS.index(name)
+    return mask
+
+
+def punct_mask(marks, where):
+    mask = 0
+    for mark in marks:
+        if len(mark) != 1 or mark not in FRAME_PUNCT:
+            sys.exit(f"error: {where}: unsupported punctuation '{mark}'")
+        mask |= 1 << FRAME_PUNCT.index(mark)
+    return mask
+
+
+def compile_condition(condition, where):
+    """Compile an OR of context conditions into (flags, registers, punct, sentence_len, token words)."""
+    flags, registers, punct, sentence_len, tokens = 0, 0, 0, GATE_NO_SENTENCE_LEN, []
+    for term in condition.split(" OR "):
+        term = term.strip()
+        if term == "true":
+            flags |= GATE_ALWAYS
+        elif term == "context.is_question==true":
+            flags |= GATE_QUESTION
+        elif match := re.fullmatch(r"context\.register\s*==\s*(\w+)", term):
+            registers |= register_mask([match[1]], where)
+        elif match := re.fullmatch(r"context\.register in (\{.*\})", term):
+            registers |= register_mask(parse_items(match[1]), where)
+        elif match := re.fullmatch(r"context\.punct in (\{.*\})", term):
+            punct |= punct_mask(parse_items(match[1]), where)
+        elif match := re.fullmatch(r"context\.sentence_len\s*>=\s*(\d+)", term):
+            sentence_len = min(sentence_len, int(match[1]))
+        elif match := re.fullmatch(r"context\.last_token in (\{.*\})", term):
+            # A punctuation mark as the last token is the punctuation context
+            for item in parse_items(match[1]):
+                if item in FRAME_PUNCT:
+                    punct |= punct_mask([item], where)
+                else:
+                    tokens.append(item.lower())
+        else:
+            sys.exit(f"error: {where}: unsupported condition '{term}'")
+    return flags, registers, punct, sentence_len, tokens
+
+
+def build_frames(data_dir):
+    """Compile the frames, their token sets and their gating rules into the frame tables.
+
+    Every token set, every literal frame token and the last_token list of every gate gets a set
+    bit; each word stores the mask of the sets it belongs to. Boosts become Q8 score scales,
+    FRAME_SCALE_ONE / boost, since a lower score ranks higher.
+    """
+    sets = {}  # Set name -> bit
+    words = {}  # Word -> set mask
+
+    def add_set(name, items):
+        if len(sets) >= FRAME_MAX_SETS:
+            sys.exit(f"error: more than {FRAME_MAX_SETS} token sets")
+        bit = sets[name] = len(sets)
+        for item in items:
+            word = item.lower()
+            if len(word.encode()) >= FRAME_WORD_SIZE:
+                sys.exit(f"error: token '{item}' longer than {FRAME_WORD_SIZE - 1} characters")
+            words[word] = words.get(word, 0) | (1 << bit)
+        return bit
+
+    for number, (name, items) in read_tsv(data_dir / FRAME_SET_FILE, 2):
+        if name in sets:
+            sys.exit(f"error: {FRAME_SET_FILE}:{number}: duplicate set {name}")
+        add_set(name, parse_items(items))
+
+    gates = {}  # Gate name -> index
+    gate_records = b""
+    for number, (name, condition, boost, _notes) in read_tsv(data_dir / GATE_FILE, 4):
+        where = f"{GATE_FILE}:{number}"
+        flags, registers, punct, sentence_len, tokens = compile_condition(condition, where)
+        token_mask = 1 << add_set(f"gate {name}", tokens) if tokens else 0
+        scale = round(FRAME_SCALE_ONE / float(boost))
+        if not 0 < scale <= 0xFFFF:
+            sys.exit(f"error: {where}: boost {boost} out of range")
+        gates[name] = len(gates)
+        gate_records += struct.pack("<IHBBBBxx", token_mask, scale, flags, registers, punct, sentence_len)
+
+    frame_records = b""
+    frame_count = 0
+    for number, (name, pattern, _description, applies_to, gate) in read_tsv(data_dir / FRAME_FILE, 5):
+        where = f"{FRAME_FILE}:{number}"
+        slots = []
+        for token in pattern.split():
+            if token.startswith("{"):
+                if token.strip("{}") not in sets:
+                    sys.exit(f"error: {where}: unknown set {token}")
+                slots.append(sets[token.strip("{}")])
+            else:
+                literal = f"'{token.lower()}'"
+                slots.append(sets[literal] if literal in sets else add_set(literal, [token]))
+        if not 2 <= len(slots) <= FRAME_MAX_SLOTS:
+            sys.exit(f"error: {where}: frame {name} needs 2 to {FRAME_MAX_SLOTS} tokens")
+        if gate not in gates:
+            sys.exit(f"error: {where}: unknown gate rule {gate}")
+        registers = 0 if applies_to == "any" else register_mask([applies_to], where)
+        slot_count = len(slots)
+        slots += [0] * (FRAME_MAX_SLOTS - slot_count)
+        frame_records += struct.pack(f"<BBB{FRAME_MAX_SLOTS}Bx", gates[gate], registers, slot_count, *slots)
+        frame_count += 1
+
+    word_records = b"".join(
+        struct.pack(f"<{FRAME_WORD_SIZE}sI", word.encode(), mask)
+        for word, mask in sorted(words.items(), key=lambda item: item[0].encode()))
+    header = struct.pack("<IHBBHBx", FRAME_MAGIC, FRAME_VERSION, len(gates), frame_count, len(words), len(sets))
+    return header + gate_records + frame_records + word_records, frame_count, len(sets), len(words)
+
+
+def dict_class(byte):
+    """Character class of a byte in the bucket index, monotonic in byte order."""
+    if byte < ord("a"):
+        return 0
+    return byte - ord("a") + 1 if byte <= ord("z") else DICT_CLASSES - 1
+
+
+def dict_bucket(word):
+    return dict_class(word[0]) * DICT_CLASSES + (dict_class(word[1]) if len(word) > 1 else 0)
+
+
+def blocks_for(size):
+    return (size + DICT_BLOCK_SIZE - 1) // DICT_BLOCK_SIZE
+
+
+def build_dictionary(path):
+    """Compile a frequency-ordered word list into the block-indexed dictionary.
+
+    Layout, in 512-byte blocks: header and bucket index | top records | word blocks.
+    Words are lowercase and sorted bytewise. A word block holds an entry count, then
+    entries of uint16_t rank (source line), uint8_t length with DICT_CAPITALIZED, and the
+    word; no entry straddles blocks. The bucket index gives the block holding the first word
+    of each two-character bucket. Top records list the best three words of each prefix of one
+    or two letters, which span too many blocks to scan, as block << 16 | offset refs.
+    """
+    entries = {}
+    for number, line in enumerate(path.read_bytes().replace(b"\r", b"\n").split(b"\n"), 1):
+        word = line.strip()
+        if not word or word.startswith(b"#"):
+            continue
+        if len(word) >= MAX_WORD_LEN:
+            if strict:
+                sys.exit(f"error: {path.name}:{number}: word longer than {MAX_WORD_LEN - 1} characters")
+            continue
+        lower = word.lower()
+        if lower not in entries:
+            entries[lower] = (min(len(entries), DICT_MAX_RANK), DICT_CAPITALIZED if word[:1].isupper() else 0)
+    words = sorted(entries)
+
+    header_size = struct.calcsize("<IHHIHH") + (DICT_BUCKETS + 1) * 2
+    tops_block = blocks_for(header_size)
+    words_block = tops_block + blocks_for(DICT_TOP_RECORDS * DICT_TOP_SIZE)
+
+    blocks, block, count, refs = [], bytearray(1), 0, {}
+    for word in words:
+        rank, flags = entries[word]
+        record = struct.pack("<HB", rank, len(word) | flags) + word
+        if len(block) + len(record) > DICT_BLOCK_SIZE or count == 0xFF:
+            block[0] = count
+            blocks.append(bytes(block).ljust(DICT_BLOCK_SIZE, b"\0"))
+            block, count = bytearray(1), 0
+        refs[word] = ((words_block + len(blocks)) << 16) | len(block)
+        block += record
+        count += 1
+    block[0] = count
+    blocks.append(bytes(block).ljust(DICT_BLOCK_SIZE, b"\0"))
+    last_block = words_block + len(blocks) - 1
+    if last_block > 0xFFFF:
+        sys.exit(f"error: {path.name}: dictionary exceeds {0xFFFF} blocks")
+
+    # Empty buckets point at the block where their words would be
+    index = [None] * (DICT_BUCKETS + 1)
+    for word in words:
+        bucket = dict_bucket(word)
+        if index[bucket] is None:
+            index[bucket] = refs[word] >> 16
+    index[DICT_BUCKETS] = last_block
+    for bucket in reversed(range(DICT_BUCKETS)):
+        if index[bucket] is None:
+            index[bucket] = index[bucket + 1]
+
+    # Best words of each one- and two-letter prefix, by rank
+    tops = [[] for _ in range(DICT_TOP_RECORDS)]
+    letters = range(1, DICT_CLASSES - 1)
+    for word in sorted(words, key=lambda w: entries[w][0]):
+        first = dict_class(word[0])
+        if first not in letters:
+            continue
+        keys = [DICT_BUCKETS + first]
+        if len(word) > 1 and dict_class(word[1]) in letters:
+            keys.append(dict_bucket(word))
+        for key in keys:
+            if len(tops[key]) < DICT_TOP_COUNT:
+                tops[key].append(refs[word])
+    top_records = b"".join(
+        struct.pack("<3I4x", *(top + [DICT_NO_REF] * (DICT_TOP_COUNT - len(top)))) for top in tops)
+
+    header = struct.pack("<IHHIHH", DICT_MAGIC, DICT_VERSION, DICT_BLOCK_SIZE, len(words), tops_block, words_block)
+    header += struct.pack(f"<{DICT_BUCKETS + 1}H", *index)
+    blob = header.ljust(tops_block * DICT_BLOCK_SIZE, b"\0")
+    blob += top_records.ljust((words_block - tops_block) * DICT_BLOCK_SIZE, b"\0")
+    return blob + b"".join(blocks), len(words), len(blocks)
+
+
+def pack_output(output, name):
+    """Path of a companion output file, with the language pack suffix of the lexicon's name."""
+    suffix = output.stem[len("lexicon"):] if output.stem.startswith("lexicon") else ""
+    name = Path(name)
+    return output.with_name(name.stem + suffix + name.suffix)
+
+
+def main():
+    global strict
+    parser = argparse.ArgumentParser(
+        description=__doc__.split("\n\n")[0], formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--strict", action="store_true",
+                        help="fail on input the device would drop and check the shared limits")
+    parser.add_argument("data_dir", nargs="?", type=Path, metavar="DATA_DIR",
+                        help="directory of source files (default: data)")
+    parser.add_argument("output", nargs="?", type=Path, metavar="OUTPUT",
+                        help="lexicon to write (default: DATA_DIR/lexicon.t9l)")
+    args = parser.parse_args()
+
+    strict = args.strict
+    source_dir = Path(__file__).parent.parent
+    data_dir = args.data_dir or source_dir / "data"
+    output = args.output or data_dir / "lexicon.t9l"
+    if strict:
+        check_limits(source_dir)
+
+    blob, tiers, node_count = build(data_dir)
+    output.write_bytes(blob)
+    counts = ", ".join(f"{name.split('_')[0]}={len(words)}" for name, words in zip(TIER_FILES, tiers))
+    checksum = struct.unpack_from(f"<{PART_COUNT}I", blob, 8 + 4 * PART_COUNT)
+    print(f"{output}: {len(blob)} bytes ({counts}, {node_count} trie nodes, "
+          f"checksums {' '.join(f'{value:08x}' for value in checksum)})")
+
+    bigram_source = data_dir / BIGRAM_FILE
+    if bigram_source.exists():
+        bigram_output = pack_output(output, BIGRAM_OUTPUT)
+        blob, records = build_bigrams(bigram_source)
+        bigram_output.write_bytes(blob)
+        print(f"{bigram_output}: {len(blob)} bytes ({records} previous words)")
+
+    if all((data_dir / name).exists() for name in (FRAME_FILE, FRAME_SET_FILE, GATE_FILE)):
+        frame_output = pack_output(output, FRAME_OUTPUT)
+        blob, frames, sets, words = build_frames(data_dir)
+        frame_output.write_bytes(blob)
+        print(f"{frame_output}: {len(blob)} bytes ({frames} frames, {sets} token sets, {words} words)")
+
+    dict_source = data_dir / DICT_FILE
+    if dict_source.exists():
+        dict_output = pack_output(output, DICT_OUTPUT)
+        blob, words, blocks = build_dictionary(dict_source)
+        dict_output.write_bytes(blob)
+        print(f"{dict_output}: {len(blob)} bytes ({words} words in {blocks} blocks)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,73 @@
+#pragma once
+
+// Host stand-in for the parts of the Flipper Zero furi API used by t9plus.c.
+// Allocation goes through counting wrappers so benchmarks can report heap use.
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UNUSED(x) (void)(x)
+#define COUNT_OF(x) (sizeof(x) / sizeof(x[0]))
+
+void host_log(char level, const char* tag, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#define FURI_LOG_E(tag, ...) host_log('E', tag, __VA_ARGS__)
+#define FURI_LOG_W(tag, ...) host_log('W', tag, __VA_ARGS__)
+#define FURI_LOG_I(tag, ...) host_log('I', tag, __VA_ARGS__)
+#define FURI_LOG_D(tag, ...) host_log('D', tag, __VA_ARGS__)
+#define FURI_LOG_T(tag, ...) host_log('T', tag, __VA_ARGS__)
+
+void host_check_failed(const char* file, int line);
+
+#define furi_check(x)                                   \
+    do {                                                \
+        if(!(x)) host_check_failed(__FILE__, __LINE__); \
+    } while(0)
+#define furi_assert(x) furi_check(x)
+
+void* furi_record_open(const char* name);
+void furi_record_close(const char* name);
+uint32_t furi_get_tick(void);
+void furi_delay_ms(uint32_t milliseconds);
+
+// Threads, backed by pthreads
+typedef struct FuriThread FuriThread;
+typedef int32_t (*FuriThreadCallback)(void* context);
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context);
+void furi_thread_free(FuriThread* thread);
+void furi_thread_start(FuriThread* thread);
+bool furi_thread_join(FuriThread* thread);
+
+// Counting allocator, see host_furi.c
+void* host_malloc(size_t size);
+void* host_realloc(void* ptr, size_t size);
+void host_free(void* ptr);
+char* host_strdup(const char* str);
+
+#define malloc(size) host_malloc(size)
+#define realloc(ptr, size) host_realloc(ptr, size)
+#define free(ptr) host_free(ptr)
+#define strdup(str) host_strdup(str)
+
+typedef struct {
+    size_t current;     // Bytes currently allocated
+    size_t peak;        // Highest value of current since the last reset
+    size_t allocations; // Number of malloc/realloc calls since the last reset
+} HostHeapStats;
+
+const HostHeapStats* host_heap_stats(void);
+void host_heap_reset_peak(void);
+
+// Free heap as reported by furi's memmgr, relative to a nominal device heap
+size_t memmgr_get_free_heap(void);
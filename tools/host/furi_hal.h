@@ -0,0 +1,15 @@
+#pragma once
+
+// Host stand-in for the furi_hal pieces used by T9PLUS_STATS builds
+
+#include <furi.h>
+
+typedef struct {
+    volatile uint32_t CYCCNT;
+} HostDWT;
+
+HostDWT* host_dwt(void);
+
+#define DWT (host_dwt())
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void);
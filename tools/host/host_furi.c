@@ -0,0 +1,352 @@
+// Host implementations of the furi and storage stand-ins in this directory.
+
+#include <furi.h>
+#include <furi_hal.h>
+#include <storage/storage.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <time.h>
+
+// Undo the counting allocator macros, this file implements them
+#undef malloc
+#undef realloc
+#undef free
+#undef strdup
+
+#define DEVICE_DATA_DIR "/ext/apps_data/type_aid/data/"
+#define DEVICE_EXT_DIR "/ext/"
+#define MAX_HIDDEN 8
+
+// Nominal figures of a Flipper Zero: heap available to apps and core clock
+#define DEVICE_HEAP_SIZE (160 * 1024)
+#define DEVICE_CYCLES_PER_US 64
+
+// ============================================================================
+// LOGGING AND MISC
+// ============================================================================
+
+static int host_log_enabled = -1;
+
+void host_log(char level, const char* tag, const char* format, ...) {
+    if(host_log_enabled < 0) {
+        host_log_enabled = getenv("T9PLUS_HOST_LOG") != NULL;
+    }
+    if(!host_log_enabled && level != 'E') return;
+
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "[%c][%s] ", level, tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+void host_check_failed(const char* file, int line) {
+    fprintf(stderr, "furi_check failed at %s:%d\n", file, line);
+    abort();
+}
+
+void* furi_record_open(const char* name) {
+    UNUSED(name);
+    return (void*)1;
+}
+
+void furi_record_close(const char* name) {
+    UNUSED(name);
+}
+
+uint32_t furi_get_tick(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+// Cycle counter that advances at the device clock rate, refreshed on every DWT access
+static HostDWT host_dwt_regs;
+
+HostDWT* host_dwt(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t ns = (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+    host_dwt_regs.CYCCNT = (uint32_t)(ns * DEVICE_CYCLES_PER_US / 1000);
+    return &host_dwt_regs;
+}
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void) {
+    return DEVICE_CYCLES_PER_US;
+}
+
+// ============================================================================
+// THREADS
+// ============================================================================
+
+struct FuriThread {
+    pthread_t handle;
+    FuriThreadCallback callback;
+    void* context;
+    bool started;
+};
+
+static void* host_thread_main(void* arg) {
+    FuriThread* thread = arg;
+    thread->callback(thread->context);
+    return NULL;
+}
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context) {
+    UNUSED(name);
+    UNUSED(stack_size); // Host threads get the platform's default stack
+    FuriThread* thread = calloc(1, sizeof(FuriThread));
+    furi_check(thread);
+    thread->callback = callback;
+    thread->context = context;
+    return thread;
+}
+
+void furi_thread_free(FuriThread* thread) {
+    free(thread);
+}
+
+void furi_thread_start(FuriThread* thread) {
+    furi_check(pthread_create(&thread->handle, NULL, host_thread_main, thread) == 0);
+    thread->started = true;
+}
+
+bool furi_thread_join(FuriThread* thread) {
+    if(thread->started) {
+        pthread_join(thread->handle, NULL);
+        thread->started = false;
+    }
+    return true;
+}
+
+void furi_delay_ms(uint32_t milliseconds) {
+    struct timespec delay = {.tv_sec = milliseconds / 1000, .tv_nsec = (milliseconds % 1000) * 1000000L};
+    nanosleep(&delay, NULL);
+}
+
+// ============================================================================
+// COUNTING ALLOCATOR
+// ============================================================================
+
+// Every block is prefixed with its size
+typedef union {
+    size_t size;
+    max_align_t align;
+} BlockHeader;
+
+static HostHeapStats heap_stats;
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER; // The engine allocates on its loader thread
+
+static void heap_account(size_t added, size_t removed) {
+    pthread_mutex_lock(&heap_lock);
+    heap_stats.allocations += added > 0;
+    heap_stats.current += added;
+    heap_stats.current -= removed;
+    if(heap_stats.current > heap_stats.peak) heap_stats.peak = heap_stats.current;
+    pthread_mutex_unlock(&heap_lock);
+}
+
+void* host_malloc(size_t size) {
+    // Like furi's malloc, running out of memory is fatal rather than returning NULL
+    BlockHeader* block = malloc(sizeof(BlockHeader) + size);
+    furi_check(block);
+    block->size = size;
+    heap_account(size, 0);
+    return block + 1;
+}
+
+void* host_realloc(void* ptr, size_t size) {
+    if(!ptr) return host_malloc(size);
+
+    BlockHeader* block = (BlockHeader*)ptr - 1;
+    size_t old_size = block->size;
+    block = realloc(block, sizeof(BlockHeader) + size);
+    furi_check(block);
+    block->size = size;
+    heap_account(size, old_size);
+    return block + 1;
+}
+
+void host_free(void* ptr) {
+    if(!ptr) return;
+
+    BlockHeader* block = (BlockHeader*)ptr - 1;
+    heap_account(0, block->size);
+    free(block);
+}
+
+char* host_strdup(const char* str) {
+    size_t len = strlen(str) + 1;
+    char* copy = host_malloc(len);
+    memcpy(copy, str, len);
+    return copy;
+}
+
+const HostHeapStats* host_heap_stats(void) {
+    return &heap_stats;
+}
+
+void host_heap_reset_peak(void) {
+    heap_stats.peak = heap_stats.current;
+    heap_stats.allocations = 0;
+}
+
+size_t memmgr_get_free_heap(void) {
+    return heap_stats.current < DEVICE_HEAP_SIZE ? DEVICE_HEAP_SIZE - heap_stats.current : 0;
+}
+
+// ============================================================================
+// STORAGE
+// ============================================================================
+
+struct File {
+    FILE* fp;
+};
+
+static const char* data_dir = "data";
+static const char* scratch_dir = "/tmp/t9plus_host";
+static const char* hidden[MAX_HIDDEN];
+static size_t hidden_count;
+static HostStorageStats storage_stats;
+
+void host_storage_set_dirs(const char* data, const char* scratch) {
+    data_dir = data;
+    scratch_dir = scratch;
+}
+
+void host_storage_hide(const char* name) {
+    furi_check(hidden_count < MAX_HIDDEN);
+    hidden[hidden_count++] = name;
+}
+
+const HostStorageStats* host_storage_stats(void) {
+    return &storage_stats;
+}
+
+// Map a device path to a host path: data files to data_dir, everything else on /ext to scratch_dir
+static bool host_path(const char* path, char* out, size_t out_size) {
+    if(strncmp(path, DEVICE_DATA_DIR, strlen(DEVICE_DATA_DIR)) == 0) {
+        const char* name = path + strlen(DEVICE_DATA_DIR);
+        for(size_t i = 0; i < hidden_count; i++) {
+            if(strcmp(name, hidden[i]) == 0) return false;
+        }
+        snprintf(out, out_size, "%s/%s", data_dir, name);
+        return true;
+    }
+    if(strncmp(path, DEVICE_EXT_DIR, strlen(DEVICE_EXT_DIR)) == 0) {
+        snprintf(out, out_size, "%s/%s", scratch_dir, path + strlen(DEVICE_EXT_DIR));
+        return true;
+    }
+    return false;
+}
+
+File* storage_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    File* file = host_malloc(sizeof(File));
+    file->fp = NULL;
+    return file;
+}
+
+void storage_file_free(File* file) {
+    storage_file_close(file);
+    host_free(file);
+}
+
+bool storage_file_open(File* file, const char* path, FS_AccessMode access_mode, FS_OpenMode open_mode) {
+    char host[512];
+    if(!host_path(path, host, sizeof(host))) return false;
+
+    const char* mode = "rb";
+    if(access_mode & FSAM_WRITE) {
+        if(open_mode & FSOM_OPEN_APPEND) {
+            mode = (access_mode & FSAM_READ) ? "a+b" : "ab";
+        } else if(open_mode & (FSOM_CREATE_ALWAYS | FSOM_CREATE_NEW)) {
+            mode = (access_mode & FSAM_READ) ? "w+b" : "wb";
+        } else {
+            // Open existing or always: create the file if needed without truncating it
+            FILE* probe = fopen(host, "ab");
+            if(!probe) return false;
+            fclose(probe);
+            mode = "r+b";
+        }
+    }
+
+    file->fp = fopen(host, mode);
+    if(file->fp) storage_stats.opens++;
+    return file->fp != NULL;
+}
+
+bool storage_file_close(File* file) {
+    if(!file->fp) return false;
+    fclose(file->fp);
+    file->fp = NULL;
+    return true;
+}
+
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read) {
+    size_t bytes_read = fread(buff, 1, bytes_to_read, file->fp);
+    storage_stats.reads++;
+    storage_stats.bytes_read += bytes_read;
+    return bytes_read;
+}
+
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write) {
+    return fwrite(buff, 1, bytes_to_write, file->fp);
+}
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start) {
+    return fseek(file->fp, offset, from_start ? SEEK_SET : SEEK_CUR) == 0;
+}
+
+uint64_t storage_file_size(File* file) {
+    long position = ftell(file->fp);
+    fseek(file->fp, 0, SEEK_END);
+    long size = ftell(file->fp);
+    fseek(file->fp, position, SEEK_SET);
+    return size;
+}
+
+bool storage_file_eof(File* file) {
+    return feof(file->fp) != 0;
+}
+
+FS_Error storage_common_remove(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char host[512];
+    if(!host_path(path, host, sizeof(host))) return FSE_INVALID_NAME;
+    return remove(host) == 0 ? FSE_OK : FSE_NOT_EXIST;
+}
+
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path) {
+    UNUSED(storage);
+    char old_host[512];
+    char new_host[512];
+    if(!host_path(old_path, old_host, sizeof(old_host)) || !host_path(new_path, new_host, sizeof(new_host))) {
+        return FSE_INVALID_NAME;
+    }
+    return rename(old_host, new_host) == 0 ? FSE_OK : FSE_INTERNAL;
+}
+
+FS_Error storage_common_stat(Storage* storage, const char* path, FileInfo* fileinfo) {
+    UNUSED(storage);
+    char host[512];
+    struct stat info;
+    if(!host_path(path, host, sizeof(host)) || stat(host, &info) != 0) return FSE_NOT_EXIST;
+    fileinfo->flags = S_ISDIR(info.st_mode) ? 1 : 0;  // FSF_DIRECTORY
+    fileinfo->size = info.st_size;
+    return FSE_OK;
+}
+
+FS_Error storage_common_timestamp(Storage* storage, const char* path, uint32_t* timestamp) {
+    UNUSED(storage);
+    char host[512];
+    struct stat info;
+    if(!host_path(path, host, sizeof(host)) || stat(host, &info) != 0) return FSE_NOT_EXIST;
+    *timestamp = info.st_mtime;
+    return FSE_OK;
+}
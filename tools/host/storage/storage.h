@@ -0,0 +1,69 @@
+#pragma once
+
+// Host stand-in for the Flipper Zero storage API, backed by stdio.
+// Paths under the app's data directory are mapped to a host directory, see host_furi.c.
+
+#include <furi.h>
+
+#define RECORD_STORAGE "storage"
+
+typedef struct Storage Storage;
+typedef struct File File;
+
+typedef enum {
+    FSAM_READ = (1 << 0),
+    FSAM_WRITE = (1 << 1),
+    FSAM_READ_WRITE = FSAM_READ | FSAM_WRITE,
+} FS_AccessMode;
+
+typedef enum {
+    FSOM_OPEN_EXISTING = 1,
+    FSOM_OPEN_ALWAYS = 2,
+    FSOM_OPEN_APPEND = 4,
+    FSOM_CREATE_NEW = 8,
+    FSOM_CREATE_ALWAYS = 16,
+} FS_OpenMode;
+
+typedef enum {
+    FSE_OK,
+    FSE_NOT_READY,
+    FSE_EXIST,
+    FSE_NOT_EXIST,
+    FSE_INVALID_PARAMETER,
+    FSE_DENIED,
+    FSE_INVALID_NAME,
+    FSE_INTERNAL,
+    FSE_NOT_IMPLEMENTED,
+    FSE_ALREADY_OPEN,
+} FS_Error;
+
+typedef struct {
+    uint32_t flags;
+    uint64_t size;
+} FileInfo;
+
+File* storage_file_alloc(Storage* storage);
+void storage_file_free(File* file);
+bool storage_file_open(File* file, const char* path, FS_AccessMode access_mode, FS_OpenMode open_mode);
+bool storage_file_close(File* file);
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read);
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write);
+bool storage_file_seek(File* file, uint32_t offset, bool from_start);
+uint64_t storage_file_size(File* file);
+bool storage_file_eof(File* file);
+FS_Error storage_common_remove(Storage* storage, const char* path);
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path);
+FS_Error storage_common_stat(Storage* storage, const char* path, FileInfo* fileinfo);
+FS_Error storage_common_timestamp(Storage* storage, const char* path, uint32_t* timestamp);
+
+// Host-only: where device paths are mapped and which files are hidden
+void host_storage_set_dirs(const char* data_dir, const char* scratch_dir);
+void host_storage_hide(const char* name);
+
+typedef struct {
+    size_t opens;
+    size_t reads;
+    size_t bytes_read;
+} HostStorageStats;
+
+const HostStorageStats* host_storage_stats(void);
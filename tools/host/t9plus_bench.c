@@ -0,0 +1,530 @@
+// Host benchmark for the T9+ engine: init cost, heap use and lookup latency.
+//
+// Replays a corpus as if it were typed one character at a time and times each
+// suggestion lookup, both through t9plus_get_suggestions() on the whole text
+// buffer (as the app did originally) and through a typing context, as the app does now.
+//
+// With -q it instead types the corpus on the T9 screen's keys, the way
+// t9_add_character(), t9_cycle_suggestion() and t9_accept_suggestion() do
+// in the app, and reports how many button presses the suggestions save.
+
+#include "t9plus.h"
+#include <storage/storage.h>
+#include <ctype.h>
+#include <sched.h>
+#include <time.h>
+
+// The benchmark's own buffers are not part of the engine's heap statistics
+#undef malloc
+#undef realloc
+#undef free
+#undef strdup
+
+// Same limit as the app's text buffer
+#define TEXT_BUFFER_SIZE 1024
+
+// Same key lines as the app's English keyboard, so lookups pay for typo tolerance as in the app
+static const char* const key_lines[] = {"1234567890", "qwertyuiop[]", "asdfghjkl'", "zxcvbnm,;.:-", ""};
+static const char* const key_lines_upper[] = {"!\"\xc2\xa7$%&@()#", "QWERTYUIOP[]", "ASDFGHJKL'", "ZXCVBNM,;.:-", ""};
+
+// Special keys of the T9 screen, as in type-aid.c
+#define KEY_LINE_COUNT 5
+#define KEY_LINE_BACK 0   // Backspace after the last key
+#define KEY_LINE_SHIFT 3  // Shift lock at position -1
+#define KEY_LINE_SPACE 4  // Space at position -1
+#define KEY_POS_COUNT 14  // Positions -1 to 12
+
+typedef struct {
+    uint32_t* samples; // Latencies in nanoseconds
+    size_t count;
+    size_t capacity;
+} Samples;
+
+static uint64_t now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+static void samples_add(Samples* samples, uint64_t ns) {
+    if(samples->count == samples->capacity) {
+        samples->capacity = samples->capacity ? samples->capacity * 2 : 4096;
+        samples->samples = realloc(samples->samples, samples->capacity * sizeof(uint32_t));
+    }
+    samples->samples[samples->count++] = ns > UINT32_MAX ? UINT32_MAX : ns;
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+static void samples_report(const char* name, Samples* samples) {
+    if(samples->count == 0) {
+        printf("%-28s no samples\n", name);
+        return;
+    }
+    qsort(samples->samples, samples->count, sizeof(uint32_t), compare_u32);
+    uint32_t p50 = samples->samples[samples->count / 2];
+    uint32_t p99 = samples->samples[(samples->count * 99) / 100];
+    uint32_t max = samples->samples[samples->count - 1];
+    printf(
+        "%-28s %8zu lookups  p50 %7.3f us  p99 %7.3f us  max %8.3f us\n",
+        name,
+        samples->count,
+        p50 / 1000.0,
+        p99 / 1000.0,
+        max / 1000.0);
+}
+
+// Load the corpus into memory: whitespace separated words, kept as typed
+static char* load_corpus(const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if(!fp) {
+        fprintf(stderr, "Cannot open corpus %s\n", path);
+        exit(1);
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    char* corpus = calloc(size + 1, 1);
+    if(fread(corpus, 1, size, fp) != (size_t)size) {
+        fprintf(stderr, "Cannot read corpus %s\n", path);
+        exit(1);
+    }
+    fclose(fp);
+    return corpus;
+}
+
+// Type the corpus into a text buffer and time a lookup after every character
+static void replay(const char* corpus, Samples* buffer_lookups, Samples* context_lookups) {
+    char buffer[TEXT_BUFFER_SIZE] = {0};
+    size_t len = 0;
+    char suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH];
+    T9PlusContext ctx;
+    T9PlusSuggestionList list;
+
+    t9plus_context_reset(&ctx);
+    for(const char* p = corpus; *p; p++) {
+        char c = *p;
+        if(isspace((unsigned char)c)) {
+            if(len == 0 || buffer[len - 1] == ' ') continue;
+            c = ' ';
+        }
+        if(len + 1 >= TEXT_BUFFER_SIZE) {
+            len = 0;
+            t9plus_context_reset(&ctx);
+        }
+        buffer[len++] = c;
+        buffer[len] = '\0';
+
+        uint64_t start = now_ns();
+        t9plus_get_suggestions(buffer, suggestions, T9PLUS_MAX_SUGGESTIONS);
+        samples_add(buffer_lookups, now_ns() - start);
+
+        start = now_ns();
+        t9plus_context_push_char(&ctx, c);
+        t9plus_get_suggestion_list_ctx(&ctx, &list);
+        samples_add(context_lookups, now_ns() - start);
+    }
+}
+
+// Position of the key cursor on the T9 screen, and the shift lock
+typedef struct {
+    int8_t line;
+    int8_t pos;
+    bool shift;
+} KeyCursor;
+
+// Button presses of a replay, counted as in the app: every arrow press, OK and long Right
+typedef struct {
+    size_t moves;   // Arrow presses moving the key cursor
+    size_t presses; // All button presses, the moves included
+} KeyTally;
+
+// Suggestion quality of a replay
+typedef struct {
+    size_t chars;         // Characters of the typed text
+    size_t skipped;       // Corpus characters without a key, left out
+    size_t words;         // Words typed or accepted
+    size_t accepted;      // Words taken from the suggestions
+    size_t lookups;       // Lookups seen while typing a word
+    size_t top1;          // ... with the word as the first suggestion
+    size_t top3;          // ... with the word among the suggestions
+    KeyTally typed;       // Typing everything on the keys
+    KeyTally suggested;   // Taking suggestions when that takes fewer presses
+} Quality;
+
+// Fewest arrow presses between two key positions, indexed [line][pos + 1]
+static uint8_t key_distance[KEY_LINE_COUNT][KEY_POS_COUNT][KEY_LINE_COUNT][KEY_POS_COUNT];
+
+static int8_t key_line_max(int8_t line) {
+    int8_t max_pos = strlen(key_lines[line]) - 1;
+    return line == KEY_LINE_BACK ? max_pos + 1 : max_pos;
+}
+
+static int8_t key_line_min(int8_t line) {
+    return line == KEY_LINE_SHIFT || line == KEY_LINE_SPACE ? -1 : 0;
+}
+
+// One arrow press, as t9_move_cursor() does it: line changes clamp the position, moves past
+// the ends of a line do nothing
+static void key_step(int8_t* line, int8_t* pos, int8_t line_delta, int8_t pos_delta) {
+    if(line_delta != 0) {
+        int8_t new_line = *line + line_delta;
+        if(new_line < 0 || new_line >= KEY_LINE_COUNT) return;
+        *line = new_line;
+        if(*pos < key_line_min(*line)) *pos = key_line_min(*line);
+        if(*pos > key_line_max(*line)) *pos = key_line_max(*line);
+    } else {
+        int8_t new_pos = *pos + pos_delta;
+        if(new_pos >= key_line_min(*line) && new_pos <= key_line_max(*line)) *pos = new_pos;
+    }
+}
+
+// Breadth-first search from every key position
+static void key_distance_init(void) {
+    static const int8_t steps[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    memset(key_distance, 0xFF, sizeof(key_distance));
+    for(int8_t line = 0; line < KEY_LINE_COUNT; line++) {
+        for(int8_t pos = key_line_min(line); pos <= key_line_max(line); pos++) {
+            uint8_t (*distance)[KEY_POS_COUNT] = key_distance[line][pos + 1];
+            int8_t queue[KEY_LINE_COUNT * KEY_POS_COUNT][2];
+            size_t head = 0, tail = 0;
+            distance[line][pos + 1] = 0;
+            queue[tail][0] = line;
+            queue[tail++][1] = pos;
+            while(head < tail) {
+                int8_t from_line = queue[head][0];
+                int8_t from_pos = queue[head++][1];
+                for(size_t i = 0; i < 4; i++) {
+                    int8_t to_line = from_line;
+                    int8_t to_pos = from_pos;
+                    key_step(&to_line, &to_pos, steps[i][0], steps[i][1]);
+                    if(distance[to_line][to_pos + 1] != 0xFF) continue;
+                    distance[to_line][to_pos + 1] = distance[from_line][from_pos + 1] + 1;
+                    queue[tail][0] = to_line;
+                    queue[tail++][1] = to_pos;
+                }
+            }
+        }
+    }
+}
+
+// Find the key typing c, returning false if there is none
+static bool key_find(char c, int8_t* line, int8_t* pos, bool* shift) {
+    if(c == ' ') {
+        *line = KEY_LINE_SPACE;
+        *pos = -1;
+        *shift = false;
+        return true;
+    }
+    for(int upper = 0; upper < 2; upper++) {
+        const char* const* lines = upper ? key_lines_upper : key_lines;
+        for(int8_t l = 0; l < KEY_LINE_COUNT; l++) {
+            // Positions past the unshifted line do not exist, as in the app
+            for(int8_t p = 0; p < (int8_t)strlen(key_lines[l]); p++) {
+                if(lines[l][p] == c) {
+                    *line = l;
+                    *pos = p;
+                    *shift = upper;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// Move to a key and press OK
+static void key_press(KeyCursor* cursor, int8_t line, int8_t pos, KeyTally* tally) {
+    uint8_t moves = key_distance[cursor->line][cursor->pos + 1][line][pos + 1];
+    cursor->line = line;
+    cursor->pos = pos;
+    tally->moves += moves;
+    tally->presses += moves + 1;
+}
+
+// Type one character, toggling the shift lock first if needed. Returns false if c has no key
+static bool key_type(KeyCursor* cursor, char c, KeyTally* tally) {
+    int8_t line, pos;
+    bool shift;
+    if(!key_find(c, &line, &pos, &shift)) {
+        return false;
+    }
+    if(c != ' ' && shift != cursor->shift) {
+        key_press(cursor, KEY_LINE_SHIFT, -1, tally);
+        cursor->shift = shift;
+    }
+    key_press(cursor, line, pos, tally);
+    return true;
+}
+
+// Presses to type text from the cursor's position, leaving the cursor where it is
+static size_t key_cost(KeyCursor cursor, const char* text, size_t len) {
+    KeyTally tally = {0};
+    for(size_t i = 0; i < len; i++) {
+        key_type(&cursor, text[i], &tally);
+    }
+    return tally.presses;
+}
+
+// Type one character with the suggestions on, timing the context update and the lookup
+static void quality_type(
+    Quality* quality,
+    KeyCursor* typed,
+    KeyCursor* suggested,
+    T9PlusContext* ctx,
+    T9PlusSuggestionList* list,
+    char c,
+    bool suggested_too,
+    Samples* lookups) {
+    if(!key_type(typed, c, &quality->typed)) {
+        quality->skipped++;
+        return;
+    }
+    quality->chars++;
+    if(!suggested_too) return;
+    key_type(suggested, c, &quality->suggested);
+    uint64_t start = now_ns();
+    t9plus_context_push_char(ctx, c);
+    t9plus_get_suggestion_list_ctx(ctx, list);
+    samples_add(lookups, now_ns() - start);
+}
+
+// Type the corpus on the keys twice, once ignoring the suggestions and once taking a suggestion
+// whenever cycling to it (long Right per suggestion) and accepting it (OK) takes fewer presses
+// than typing the rest of the word and the space
+static void replay_keystrokes(const char* corpus, Quality* quality, Samples* lookups) {
+    KeyCursor typed = {0, 0, false};
+    KeyCursor suggested = {0, 0, false};
+    T9PlusContext ctx;
+    T9PlusSuggestionList list;
+    t9plus_context_reset(&ctx);
+    t9plus_get_suggestion_list_ctx(&ctx, &list);
+
+    const char* p = corpus;
+    while(*p) {
+        if(isspace((unsigned char)*p)) {
+            p++;
+            continue;
+        }
+        const char* token = p;
+        while(*p && !isspace((unsigned char)*p)) p++;
+        size_t token_len = p - token;
+
+        // Characters before the word, the word, and characters after it
+        size_t start = 0;
+        while(start < token_len && !t9plus_is_word_char(token[start])) {
+            quality_type(quality, &typed, &suggested, &ctx, &list, token[start++], true, lookups);
+        }
+        size_t end = start;
+        while(end < token_len && t9plus_is_word_char(token[end])) end++;
+        if(end == start) {
+            quality_type(quality, &typed, &suggested, &ctx, &list, ' ', true, lookups);
+            continue;
+        }
+        quality->words++;
+
+        // Accepting adds a space, so only words followed by one can be accepted
+        bool acceptable = end == token_len && end - start < T9PLUS_MAX_WORD_LENGTH;
+        char word[T9PLUS_MAX_WORD_LENGTH];
+        bool accepted = false;
+        for(size_t i = start; i <= end && acceptable; i++) {
+            int8_t found = -1;
+            for(uint8_t k = 0; k < list.count; k++) {
+                if(list.items[k].length == end - start && memcmp(list.items[k].word, token + start, end - start) == 0) {
+                    found = k;
+                    break;
+                }
+            }
+            if(i < end) {
+                quality->lookups++;
+                if(found == 0) quality->top1++;
+                if(found >= 0) quality->top3++;
+            }
+            memcpy(word, token + i, end - i);
+            word[end - i] = ' ';
+            if(found >= 0 && (size_t)found + 2 < key_cost(suggested, word, end - i + 1)) {
+                // Long Right up to the suggestion, then OK
+                quality->suggested.presses += found + 2;
+                memcpy(word, token + start, end - start);
+                word[end - start] = '\0';
+                uint64_t lookup_start = now_ns();
+                t9plus_context_set_word(&ctx, word);
+                t9plus_context_push_char(&ctx, ' ');
+                t9plus_get_suggestion_list_ctx(&ctx, &list);
+                samples_add(lookups, now_ns() - lookup_start);
+                accepted = true;
+                break;
+            }
+            if(i < end) {
+                quality_type(quality, &typed, &suggested, &ctx, &list, token[i], true, lookups);
+            }
+        }
+        if(accepted) {
+            // The text is the same either way, so typing it still counts its characters
+            quality->accepted++;
+            for(size_t i = start; i < end; i++) {
+                quality_type(quality, &typed, &suggested, &ctx, &list, token[i], false, lookups);
+            }
+            quality_type(quality, &typed, &suggested, &ctx, &list, ' ', false, lookups);
+            continue;
+        }
+        for(size_t i = acceptable ? end : start; i < token_len; i++) {
+            quality_type(quality, &typed, &suggested, &ctx, &list, token[i], true, lookups);
+        }
+        quality_type(quality, &typed, &suggested, &ctx, &list, ' ', true, lookups);
+    }
+}
+
+static void quality_report(const Quality* quality) {
+    if(quality->chars == 0 || quality->typed.presses == 0) {
+        printf("keystrokes                   no characters typed\n");
+        return;
+    }
+    double chars = quality->chars;
+    printf("corpus                       %8zu chars  %zu words  %zu chars without a key\n", quality->chars, quality->words, quality->skipped);
+    printf(
+        "presses without suggestions  %8zu  %5.3f per char  %5.3f cursor moves per char\n",
+        quality->typed.presses,
+        quality->typed.presses / chars,
+        quality->typed.moves / chars);
+    printf(
+        "presses with suggestions     %8zu  %5.3f per char  %5.3f cursor moves per char\n",
+        quality->suggested.presses,
+        quality->suggested.presses / chars,
+        quality->suggested.moves / chars);
+    printf(
+        "keystrokes saved             %7.1f %%  %zu of %zu words accepted\n",
+        100.0 * (1.0 - (double)quality->suggested.presses / quality->typed.presses),
+        quality->accepted,
+        quality->words);
+    if(quality->lookups) {
+        printf(
+            "hit rate                     top-1 %5.1f %%  top-3 %5.1f %%  of %zu lookups in a word\n",
+            100.0 * quality->top1 / quality->lookups,
+            100.0 * quality->top3 / quality->lookups,
+            quality->lookups);
+    }
+}
+
+static void usage(const char* name) {
+    fprintf(
+        stderr,
+        "Usage: %s [-d DATA_DIR] [-s SCRATCH_DIR] [-c CORPUS] [-n ROUNDS] [-t] [-q]\n"
+        "  -d  directory with the data/ files (default: ../../data)\n"
+        "  -s  host directory standing in for /ext (default: /tmp/t9plus_host)\n"
+        "  -c  corpus to replay (default: DATA_DIR/unigram_1000.txt, corpus.txt with -q)\n"
+        "  -n  number of times the corpus is replayed (default: 5)\n"
+        "  -t  ignore lexicon.t9l and load the plain-text tiers\n"
+        "  -q  type the corpus on the T9 keys and report the presses the suggestions save\n",
+        name);
+}
+
+int main(int argc, char** argv) {
+    const char* data_dir = "../../data";
+    const char* scratch_dir = "/tmp/t9plus_host";
+    const char* corpus_path = NULL;
+    int rounds = 5;
+    bool text_only = false;
+    bool keystrokes = false;
+
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            data_dir = argv[++i];
+        } else if(strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            scratch_dir = argv[++i];
+        } else if(strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            corpus_path = argv[++i];
+        } else if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            rounds = atoi(argv[++i]);
+        } else if(strcmp(argv[i], "-t") == 0) {
+            text_only = true;
+        } else if(strcmp(argv[i], "-q") == 0) {
+            keystrokes = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    char default_corpus[512];
+    if(!corpus_path && keystrokes) {
+        corpus_path = "corpus.txt";
+    } else if(!corpus_path) {
+        snprintf(default_corpus, sizeof(default_corpus), "%s/unigram_1000.txt", data_dir);
+        corpus_path = default_corpus;
+    }
+    host_storage_set_dirs(data_dir, scratch_dir);
+    if(text_only) host_storage_hide("lexicon.t9l");
+
+    // Init
+    uint64_t start = now_ns();
+    if(!t9plus_init()) {
+        fprintf(stderr, "t9plus_init failed\n");
+        return 1;
+    }
+    uint64_t init_ns = now_ns() - start;
+    t9plus_set_key_layout(key_lines, sizeof(key_lines) / sizeof(key_lines[0]));
+
+    // The lexicon loads on a background thread: time until suggestions are available
+    // and until every tier is loaded. Yield so the loader also runs on a single core.
+    while(!t9plus_is_ready()) {
+        sched_yield();
+    }
+    uint64_t ready_ns = now_ns() - start;
+    while(t9plus_get_load_progress() < 100) {
+        sched_yield();
+    }
+    uint64_t loaded_ns = now_ns() - start;
+    const HostHeapStats* heap = host_heap_stats();
+    const HostStorageStats* storage = host_storage_stats();
+    const char* error = t9plus_get_error_message();
+
+    printf("init returned                %8.3f ms  (%s)\n", init_ns / 1e6, text_only ? "text tiers" : "default");
+    printf("primary tiers ready          %8.3f ms\n", ready_ns / 1e6);
+    printf("all tiers loaded             %8.3f ms\n", loaded_ns / 1e6);
+    printf("storage                      %8zu opens  %zu reads  %zu bytes\n", storage->opens, storage->reads, storage->bytes_read);
+    printf("heap after loading           %8zu bytes live  %zu bytes peak  %zu allocations\n", heap->current, heap->peak, heap->allocations);
+    if(error) printf("load status                  %s\n", error);
+
+    // Lookups
+    char* corpus = load_corpus(corpus_path);
+    Samples buffer_lookups = {0};
+    Samples context_lookups = {0};
+    host_heap_reset_peak();
+    if(keystrokes) {
+        // Words are not learned, so every round types the same and the tallies of one are reported
+        Quality quality = {0};
+        key_distance_init();
+        for(int round = 0; round < rounds; round++) {
+            quality = (Quality){0};
+            replay_keystrokes(corpus, &quality, &context_lookups);
+        }
+        quality_report(&quality);
+        samples_report("per keystroke", &context_lookups);
+    } else {
+        for(int round = 0; round < rounds; round++) {
+            replay(corpus, &buffer_lookups, &context_lookups);
+        }
+        samples_report("t9plus_get_suggestions", &buffer_lookups);
+        samples_report("context push + get", &context_lookups);
+    }
+    printf("heap during lookups          %8zu bytes peak  %zu allocations\n", heap->peak, heap->allocations);
+#if T9PLUS_STATS
+    char line[64];
+    t9plus_stats_format(line, sizeof(line));
+    printf("engine stats                 %s\n", line);
+    const T9PlusStats* stats = t9plus_get_stats();
+    printf("engine heap                  %8zu bytes peak  %zu bytes resident\n", stats->heap_peak, stats->heap_resident);
+#endif
+
+    free(buffer_lookups.samples);
+    free(context_lookups.samples);
+    free(corpus);
+    t9plus_deinit();
+    printf("heap after deinit            %8zu bytes live\n", heap->current);
+    return 0;
+}
@@ -5,6 +5,7 @@
 #include <gui/view_dispatcher.h>         // View management and navigation system
 #include <mitzi_tyaid_icons.h>           // Auto-generated header for icons in images/ folder
 #include "t9plus.h"					     // a T9 inspired word prediction system
+#include "gap_buffer.h"                  // Editable text with a caret
 
 // Debug tag for logging
 #define TAG "TypeAid"
@@ -12,7 +13,7 @@
 // ============================================================================
 // CONSTANTS AND CONFIGURATION
 // ============================================================================
-#define TEXT_BUFFER_SIZE 256
+#define TEXT_BUFFER_SIZE 1024
 #define LINE_SPACING 9
 #define Y_VALUE_DIVIDER 8
 #define SPECIAL_KEY_BACK_LINE 0
@@ -21,47 +22,123 @@
 #define T9_LINE_BACK_OFFSET 10
 #define T9_LINE_SHIFT_OFFSET 30
 #define T9_LINE_SPACE_OFFSET 25
-static const char* t9_lines[] = {
+#define T9_LINE_COUNT 5
+#define T9_KEY_SPACING 9
+#define T9_CURSOR_BLINK_MS 500  // The blink timer is the T9 screen's only periodic redraw
+#define TEXT_VIEW_WIDTH 124     // Pixels of text left of the cursor before the text line scrolls
+#define TEXT_VIEW_CHARS 64      // More characters than fit on the text line
+#define TEXT_SCROLL_MARGIN 8    // Characters kept left of the cursor when scrolling back
+#define T9_REPEAT_ACCEL_EVERY 4 // Repeats of a held arrow before its step doubles
+#define T9_REPEAT_MAX_STEP 8    // Most keys or characters a held arrow moves per repeat
+static const char* const t9_lines_qwertz[] = {
     "1234567890",
 	"qwertzuiop[]",
     "asdfghjkl'",
     "yxcvbnm,;.:-",
 	""
 };
-static const char* t9_lines_upper[] = {
+static const char* const t9_lines_qwertz_upper[] = {
     "!\"§$%&@()#",
 	"QWERTZUIOP[]",
     "ASDFGHJKL'",
     "YXCVBNM,;.:-",
 	""
 };
+static const char* const t9_lines_qwerty[] = {
+    "1234567890",
+	"qwertyuiop[]",
+    "asdfghjkl'",
+    "zxcvbnm,;.:-",
+	""
+};
+static const char* const t9_lines_qwerty_upper[] = {
+    "!\"§$%&@()#",
+	"QWERTYUIOP[]",
+    "ASDFGHJKL'",
+    "ZXCVBNM,;.:-",
+	""
+};
+
+// Key lines in use, chosen by the language pack in t9_apply_language()
+static const char* const* t9_lines = t9_lines_qwerty;
+static const char* const* t9_lines_upper = t9_lines_qwerty_upper;
+
+// Key line lengths and x positions of their first key, measured once by t9_layout_init()
+static uint8_t t9_line_len[T9_LINE_COUNT];
+static uint8_t t9_line_x[T9_LINE_COUNT];
 
 // ============================================================================
 // TYPES AND STRUCTURES
 // ============================================================================
 
+// Layout of the T9 screen's text and suggestions, measured by the draw callback
+// only after the buffer or the suggestions changed
+typedef struct {
+    bool dirty;           // The text or caret changed, set by t9_invalidate_layout()
+    uint32_t suggestions_generation;  // Generation of the suggestions suggestion_x was measured for
+    size_t view_start;    // First character of the text shown on the text line
+    uint8_t caret_x;      // Width of the text between view_start and the caret, where the cursor goes
+    char visible[TEXT_VIEW_CHARS + 1];  // The part of the text that fits on the text line
+    uint8_t suggestion_x[T9PLUS_MAX_SUGGESTIONS];
+} T9Layout;
+
+// Views of the view dispatcher
+typedef enum {
+    TypeAidViewSplash,
+    TypeAidViewTextInput,
+    TypeAidViewT9,
+} TypeAidView;
+
+// Custom events of the view dispatcher. Nothing wakes the app periodically but the blink timer
+typedef enum {
+    TypeAidEventFlush,  // Input changed the T9 screen: look up the suggestions and redraw once
+    TypeAidEventBlink,  // The blink timer fired
+    TypeAidEventLoad,   // The background load made progress
+} TypeAidEvent;
+
 typedef struct {
     Gui* gui;
-    ViewPort* view_port;
-    FuriMessageQueue* event_queue;
+    ViewDispatcher* view_dispatcher;  // Runs the app: input, redraws and the custom events
+    View* splash_view;
     TextInput* text_input;
-    ViewDispatcher* view_dispatcher;
-    ViewPort* t9_view_port;
+    View* t9_view;
+    TypeAidView current_view;
+    FuriTimer* blink_timer;  // Runs while the T9 screen is shown
+    bool flush_pending;       // A TypeAidEventFlush is queued
+    bool load_event_pending;  // A TypeAidEventLoad is queued; set on the loader thread
     
-    char text_buffer[TEXT_BUFFER_SIZE];
-    bool in_text_input;  // Track which screen we're on
+    GapBuffer text;
+    size_t caret;        // Position of the cursor in text, where the T9 screen edits
+    char* text_input_buffer;  // Flat copy of text while the standard keyboard edits it
 	bool keyboard_used;  // Track if keyboard has been opened at least once
 	
-	// Suggestion cache
-	char cached_suggestions[T9PLUS_MAX_SUGGESTIONS][T9PLUS_MAX_WORD_LENGTH];
-	uint8_t cached_suggestion_count;
-	char last_buffer_for_suggestions[TEXT_BUFFER_SIZE];  // Track when to update suggestions
+	// Suggestions, pointing into T9+ until the next list replaces them
+	T9PlusSuggestionList suggestions;
+	bool suggestions_ready;  // The T9 screen has seen t9plus_is_ready() and left "loading..."
+	T9PlusContext t9_context;  // Typing context of the text before the caret, updated with every edit
+	bool context_stale;      // The caret moved since t9_context was rebuilt, see t9_sync_context()
+	bool suggestions_stale;  // The text or caret changed since the last lookup, see t9_flush_suggestions()
+	T9Layout t9_layout;
+	bool cursor_visible;   // Blink phase, toggled by blink_timer
+	uint8_t splash_progress;  // Load progress shown by the splash screen
 	
 	// Suggestion selection state
 	int8_t selected_suggestion;  // -1 = none, 0-2 = suggestion index
-	char original_word[TEXT_BUFFER_SIZE];  // Store original typed text before previewing suggestions
+	char original_word[T9PLUS_MAX_WORD_LENGTH];  // Store original typed text before previewing suggestions
+	
+	// Held arrow state, reset by every key press
+	uint8_t repeat_count;  // Repeat events of the held key so far
+	bool hold_cycled;      // The held Right cycled a suggestion, so its repeats don't move the cursor
+#if T9PLUS_STATS
+	bool show_stats;  // Hidden overlay with lookup timings, toggled by holding Up
+#endif
 } TypeAidApp;
 
+// Model of the splash and T9 views; their state lives in the app, which the model reaches
+typedef struct {
+    TypeAidApp* app;
+} TypeAidViewModel;
+
 // ============================================================================
 // T9-MINUS SCREEN - TYPES AND DATA
 // ============================================================================
@@ -77,20 +154,91 @@ static bool shift_locked = false;
 // T9-MINUS SCREEN - DRAW CALLBACK
 // ============================================================================
 
-static void t9_draw_callback(Canvas* canvas, void* context) {
-    TypeAidApp* app = context;
+// Helper function to measure the key lines, which only change with the language
+static void t9_layout_init(void) {
+    for(uint8_t line = 0; line < T9_LINE_COUNT; line++) {
+        t9_line_len[line] = strlen(t9_lines[line]);
+        t9_line_x[line] = line == SPECIAL_KEY_SHIFT_LINE ? 2 + T9_LINE_SHIFT_OFFSET : 2;  // Space for "shft" + gap
+    }
+}
+
+// Helper function to switch the keys to the language pack in use: QWERTZ for German, QWERTY otherwise
+static void t9_apply_language(void) {
+    bool german = strcmp(t9plus_get_language_name(t9plus_get_language()), "de") == 0;
+    t9_lines = german ? t9_lines_qwertz : t9_lines_qwerty;
+    t9_lines_upper = german ? t9_lines_qwertz_upper : t9_lines_qwerty_upper;
+    t9_layout_init();
+    t9plus_set_key_layout(t9_lines, T9_LINE_COUNT);  // Neighbouring keys are tolerated as typos
+}
+
+// Helper function to scroll the text line to the caret and copy out the visible text.
+// Only the characters around the caret are measured, however long the text is
+static void t9_layout_update_text(Canvas* canvas, TypeAidApp* app) {
+    T9Layout* layout = &app->t9_layout;
+    size_t length = gap_buffer_length(&app->text);
+    size_t caret = app->caret;
+
+    // Scrolling back past the left edge keeps a few characters of context
+    if(layout->view_start > caret) {
+        layout->view_start = caret > TEXT_SCROLL_MARGIN ? caret - TEXT_SCROLL_MARGIN : 0;
+    }
+    // Scroll forward until the text before the caret fits
+    size_t start = caret;
+    uint16_t width = 0;
+    while(start > layout->view_start) {
+        uint16_t glyph = canvas_glyph_width(canvas, gap_buffer_char_at(&app->text, start - 1));
+        if(width + glyph > TEXT_VIEW_WIDTH) break;
+        width += glyph;
+        start--;
+    }
+    layout->view_start = start;
+    layout->caret_x = width;
+
+    uint16_t x = 0;
+    size_t count = 0;
+    for(size_t i = start; i < length && count < TEXT_VIEW_CHARS && x < 128; i++) {
+        char ch = gap_buffer_char_at(&app->text, i);
+        layout->visible[count++] = ch;
+        x += canvas_glyph_width(canvas, ch);
+    }
+    layout->visible[count] = '\0';
+}
+
+// Helper function to measure the text and suggestions, each only after it changed
+static void t9_layout_update(Canvas* canvas, TypeAidApp* app) {
+    T9Layout* layout = &app->t9_layout;
+    if(layout->dirty) {
+        canvas_set_font(canvas, FontSecondary);
+        t9_layout_update_text(canvas, app);
+        layout->dirty = false;
+    }
+    
+    if(layout->suggestions_generation != app->suggestions.generation) {
+        uint8_t x_pos = 2;
+        for(uint8_t i = 0; i < app->suggestions.count; i++) {
+            layout->suggestion_x[i] = x_pos;
+            x_pos += app->suggestions.items[i].length * 6 + 8;  // Approximate width and a gap
+        }
+        layout->suggestions_generation = app->suggestions.generation;
+    }
+}
+
+static void t9_draw_callback(Canvas* canvas, void* model) {
+    TypeAidApp* app = ((TypeAidViewModel*)model)->app;
     if(!app) {
         return;
     }  
+    if(app->t9_layout.dirty || app->t9_layout.suggestions_generation != app->suggestions.generation) {
+        t9_layout_update(canvas, app);
+    }
     canvas_clear(canvas);
 	canvas_set_font(canvas, FontSecondary);
-	if(strlen(app->text_buffer) > 0) { // Display current text buffer 
-        canvas_draw_str(canvas, 0, LINE_SPACING - 1, app->text_buffer);
+	if(app->t9_layout.visible[0]) { // Display the visible part of the text
+        canvas_draw_str(canvas, 0, LINE_SPACING - 1, app->t9_layout.visible);
     }  
     // Draw blinking cursor (always, even when buffer is empty)
-    if((furi_get_tick() / 500) % 2 == 0) {  // Blink every 500ms
-        uint8_t text_width = strlen(app->text_buffer) > 0 ? canvas_string_width(canvas, app->text_buffer) : 0;
-        canvas_draw_str(canvas, text_width, LINE_SPACING - 1, "|");
+    if(app->cursor_visible) {
+        canvas_draw_str(canvas, app->t9_layout.caret_x, LINE_SPACING - 1, "|");
     }	
 	// Draw horizontal line under text field
 	canvas_draw_line(canvas, 0, Y_VALUE_DIVIDER, 128, Y_VALUE_DIVIDER);
@@ -100,98 +248,54 @@ static void t9_draw_callback(Canvas* canvas, void* context) {
     
     // Check for word suggestion error message first
     const char* error_msg = t9plus_get_error_message();
+    bool show_suggestions = false;
+    if(!t9plus_is_ready()) {
+        // Lexicon still loading in the background
+        canvas_draw_str(canvas, 2, sugg_y, "loading...");
+    } else
+#if T9PLUS_STATS
+    if(app->show_stats) {
+        // Debug overlay: lookups and min/avg/max lookup time
+        char stats_line[32];
+        t9plus_stats_format(stats_line, sizeof(stats_line));
+        canvas_draw_str(canvas, 2, sugg_y, stats_line);
+    } else
+#endif
     if(error_msg != NULL) {
         // Display error message
-        canvas_set_font(canvas, FontSecondary);
         canvas_draw_str(canvas, 2, sugg_y, error_msg);
-    } else if(app->cached_suggestion_count > 0) {
-        // Display word suggestions with highlighting for selected one
-        uint8_t x_pos = 2;
-        for(uint8_t i = 0; i < app->cached_suggestion_count; i++) {
-            // Use bold font for selected suggestion
-            if(i == app->selected_suggestion) {
-                canvas_set_font(canvas, FontPrimary);
-            } else {
-                canvas_set_font(canvas, FontSecondary);
-            }
-            
-            canvas_draw_str(canvas, x_pos, sugg_y, app->cached_suggestions[i]);
-            x_pos += strlen(app->cached_suggestions[i]) * 6 + 4;  // Approximate spacing
-            
-            // Add space between suggestions
-            if(i < app->cached_suggestion_count - 1) {
-                canvas_set_font(canvas, FontSecondary);
-                canvas_draw_str(canvas, x_pos, sugg_y, " ");
-                x_pos += 4;
+    } else {
+        // Display word suggestions, the selected one in bold after the others
+        show_suggestions = true;
+        for(uint8_t i = 0; i < app->suggestions.count; i++) {
+            if(i != app->selected_suggestion) {
+                canvas_draw_str(canvas, app->t9_layout.suggestion_x[i], sugg_y, app->suggestions.items[i].word);
             }
         }
     }
     
-	// Keyboard lines follow below
+	// Keyboard lines follow below; everything in the regular font first, so the font changes only once
     const uint8_t start_y = sugg_y + LINE_SPACING;
-    const uint8_t char_spacing = 9;
-    for(uint8_t line = 0; line < 5; line++) {
+    const uint8_t bksp_x = 2 + t9_line_len[SPECIAL_KEY_BACK_LINE] * T9_KEY_SPACING;
+    const uint8_t bksp_y = start_y + SPECIAL_KEY_BACK_LINE * LINE_SPACING;
+    const uint8_t shft_y = start_y + SPECIAL_KEY_SHIFT_LINE * LINE_SPACING;
+    const uint8_t space_y = start_y + SPECIAL_KEY_SPACE_LINE * LINE_SPACING;
+    bool is_bksp_cursor = (t9_cursor.line == SPECIAL_KEY_BACK_LINE && t9_cursor.pos == (int8_t)t9_line_len[SPECIAL_KEY_BACK_LINE]);
+    bool is_shft_bold = (t9_cursor.line == SPECIAL_KEY_SHIFT_LINE && t9_cursor.pos == -1) || shift_locked;
+    bool is_space_cursor = (t9_cursor.line == SPECIAL_KEY_SPACE_LINE && t9_cursor.pos == -1);
+    
+    for(uint8_t line = 0; line < T9_LINE_COUNT; line++) {
         const char* line_str = shift_locked ? t9_lines_upper[line] : t9_lines[line];
-        size_t line_len = strlen(line_str);
-		uint8_t start_x = 2;
-     
-        if(line == SPECIAL_KEY_BACK_LINE) { // Draw backspace button 
-            uint8_t bksp_x = start_x + (line_len * char_spacing);
-            uint8_t bksp_y = start_y + (line * LINE_SPACING);
-            
-            bool is_bksp_cursor = (t9_cursor.line == SPECIAL_KEY_BACK_LINE && t9_cursor.pos == (int8_t)line_len);
-            if(is_bksp_cursor) {
-                canvas_set_font(canvas, FontPrimary);
-            } else {
-                canvas_set_font(canvas, FontSecondary);
-            }
-			canvas_draw_str(canvas, bksp_x, bksp_y, "[<]");		
-        }
-        if(line == SPECIAL_KEY_SHIFT_LINE) { // Draw "shft" button
-            uint8_t shft_x = start_x;
-            uint8_t shft_y = start_y + (line * LINE_SPACING);
-            
-            bool is_shft_cursor = (t9_cursor.line == SPECIAL_KEY_SHIFT_LINE && t9_cursor.pos == -1);
-            if(is_shft_cursor || shift_locked) {
-                canvas_set_font(canvas, FontPrimary);
-            } else {
-                canvas_set_font(canvas, FontSecondary);
-            }
-            canvas_draw_str(canvas, shft_x, shft_y, "shft");
-            start_x += T9_LINE_SHIFT_OFFSET;  // Space for "shft" + gap
-			canvas_set_font(canvas, FontSecondary);  // Reset font after shift button
-        }
-        if(line == SPECIAL_KEY_SPACE_LINE) { // Draw "[space]" button
-            uint8_t space_x = T9_LINE_SPACE_OFFSET;
-            uint8_t space_y = start_y + (line * LINE_SPACING);
-            
-            bool is_space_cursor = (t9_cursor.line == SPECIAL_KEY_SPACE_LINE && t9_cursor.pos == -1);
-            if(is_space_cursor) {
-                canvas_set_font(canvas, FontPrimary);
-            } else {
-                canvas_set_font(canvas, FontSecondary);
-            }
-            canvas_draw_str(canvas, space_x, space_y, "[space]");
-			canvas_set_font(canvas, FontSecondary);
-        }
-		
-        for(size_t i = 0; i < line_len; i++) {
-            uint8_t x = start_x + (i * char_spacing);
-            uint8_t y = start_y + (line * LINE_SPACING);
-            
-            // Set bold font for cursor position
-            bool is_cursor = (line == t9_cursor.line && (int8_t)i == t9_cursor.pos);
-            
-            if(is_cursor) {
-                canvas_set_font(canvas, FontPrimary);
-            } else {
-                canvas_set_font(canvas, FontSecondary);
-            }
-            
+        uint8_t y = start_y + (line * LINE_SPACING);
+        for(uint8_t i = 0; i < t9_line_len[line]; i++) {
+            if(line == t9_cursor.line && (int8_t)i == t9_cursor.pos) continue;
             char single_char[2] = {line_str[i], '\0'};
-            canvas_draw_str(canvas, x, y, single_char);
+            canvas_draw_str(canvas, t9_line_x[line] + (i * T9_KEY_SPACING), y, single_char);
         }
     }
+    if(!is_bksp_cursor) canvas_draw_str(canvas, bksp_x, bksp_y, "[<]");
+    if(!is_shft_bold) canvas_draw_str(canvas, 2, shft_y, "shft");
+    if(!is_space_cursor) canvas_draw_str(canvas, T9_LINE_SPACE_OFFSET, space_y, "[space]");
     
     // Draw navigation hints
     canvas_draw_icon(canvas, 0, 55, &I_back);
@@ -199,138 +303,205 @@ static void t9_draw_callback(Canvas* canvas, void* context) {
 	
 	canvas_draw_str_aligned(canvas, 128, 62, AlignRight, AlignBottom, "Hold > to compl.");
 	
+    // Then the selected suggestion and the key under the cursor in bold
+    canvas_set_font(canvas, FontPrimary);
+    if(show_suggestions && app->selected_suggestion >= 0 &&
+       app->selected_suggestion < (int8_t)app->suggestions.count) {
+        canvas_draw_str(
+            canvas,
+            app->t9_layout.suggestion_x[app->selected_suggestion],
+            sugg_y,
+            app->suggestions.items[app->selected_suggestion].word);
+    }
+    if(t9_cursor.pos >= 0 && t9_cursor.pos < (int8_t)t9_line_len[t9_cursor.line]) {
+        const char* line_str = shift_locked ? t9_lines_upper[t9_cursor.line] : t9_lines[t9_cursor.line];
+        char single_char[2] = {line_str[t9_cursor.pos], '\0'};
+        canvas_draw_str(
+            canvas,
+            t9_line_x[t9_cursor.line] + (t9_cursor.pos * T9_KEY_SPACING),
+            start_y + (t9_cursor.line * LINE_SPACING),
+            single_char);
+    }
+    if(is_bksp_cursor) canvas_draw_str(canvas, bksp_x, bksp_y, "[<]");
+    if(is_shft_bold) canvas_draw_str(canvas, 2, shft_y, "shft");
+    if(is_space_cursor) canvas_draw_str(canvas, T9_LINE_SPACE_OFFSET, space_y, "[space]");
 }
 
 // ============================================================================
-// T9-MINUS SCREEN - INPUT CALLBACK
+// T9-MINUS SCREEN - REDRAW
 // ============================================================================
 
-static void t9_input_callback(InputEvent* input_event, void* context) {
+// Helper function to redraw one of the app's own views
+static void type_aid_redraw(View* view) {
+    view_get_model(view);
+    view_commit_model(view, true);
+}
+
+// Blink timer callback: wakes the app to flip the cursor, see TypeAidEventBlink
+static void t9_blink_callback(void* context) {
     TypeAidApp* app = context;
-    furi_message_queue_put(app->event_queue, input_event, FuriWaitForever);
+    view_dispatcher_send_custom_event(app->view_dispatcher, TypeAidEventBlink);
+}
+
+// Helper function to remeasure the text and suggestions at the next redraw
+static void t9_invalidate_layout(TypeAidApp* app) {
+    app->t9_layout.dirty = true;
+}
+
+// Helper function to redraw after input, with the cursor shown and the blink restarted
+static void t9_redraw(TypeAidApp* app) {
+    app->cursor_visible = true;
+    furi_timer_start(app->blink_timer, furi_ms_to_ticks(T9_CURSOR_BLINK_MS));
+    type_aid_redraw(app->t9_view);
 }
 
 // ============================================================================
 // T9-MINUS SCREEN - NAVIGATION
 // ============================================================================
 
-// Forward declaration
-static void t9_update_suggestions(TypeAidApp* app);
+// Forward declarations
+static void t9_mark_suggestions_stale(TypeAidApp* app);
+static void t9_flush_suggestions(TypeAidApp* app);
+static void t9_sync_context(TypeAidApp* app);
 
-// Helper function to get the last word position in buffer
-static size_t get_last_word_start(const char* buffer) {
-    size_t len = strlen(buffer);
-    if(len == 0) return 0;
-    
-    // Find the start of the last word
-    size_t pos = len;
-    while(pos > 0 && buffer[pos - 1] != ' ') {
-        pos--;
+// Helper function to get the position of the word being typed, as the typing context sees it
+static size_t get_last_word_start(TypeAidApp* app) {
+    size_t word_len = app->t9_context.word_len;
+    return word_len < app->caret ? app->caret - word_len : 0;
+}
+
+// Helper function to learn the word finished at the caret, before the character ending it is added
+static void t9_learn_last_word(TypeAidApp* app, bool accepted) {
+    if(app->t9_context.word_len == 0) {
+        return;
     }
-    return pos;
+    t9plus_learn_word(gap_buffer_prefix(&app->text, app->caret) + get_last_word_start(app), accepted);
 }
 
-// Helper function to replace last word in buffer with suggestion
-static void replace_last_word_with_suggestion(TypeAidApp* app, const char* suggestion) {
-    size_t last_word_pos = get_last_word_start(app->text_buffer);
-    
-    // Copy everything before the last word
-    char new_buffer[TEXT_BUFFER_SIZE];
-    strncpy(new_buffer, app->text_buffer, last_word_pos);
-    new_buffer[last_word_pos] = '\0';
-    
-    // Manually append the suggestion (avoiding strncat)
-    size_t current_len = strlen(new_buffer);
-    size_t suggestion_len = strlen(suggestion);
-    size_t space_left = TEXT_BUFFER_SIZE - current_len - 1;
-    
-    if(suggestion_len > space_left) {
-        suggestion_len = space_left;
+// Helper function to insert one character at the caret, returning false if the text is full
+static bool t9_insert_char(TypeAidApp* app, char ch) {
+    if(gap_buffer_insert(&app->text, app->caret, &ch, 1) == 0) {
+        return false;
     }
+    app->caret++;
+    return true;
+}
+
+// Helper function to replace the word before the caret with a suggestion.
+// Only the word itself is touched, the text around it stays where it is
+static void replace_last_word_with_suggestion(TypeAidApp* app, const char* suggestion, size_t length) {
+    size_t last_word_pos = get_last_word_start(app);
     
-    memcpy(new_buffer + current_len, suggestion, suggestion_len);
-    new_buffer[current_len + suggestion_len] = '\0';
-    
-    // Update buffer
-    strncpy(app->text_buffer, new_buffer, TEXT_BUFFER_SIZE - 1);
-    app->text_buffer[TEXT_BUFFER_SIZE - 1] = '\0';
+    gap_buffer_delete(&app->text, app->caret, app->caret - last_word_pos);
+    app->caret = last_word_pos + gap_buffer_insert(&app->text, last_word_pos, suggestion, length);
+    t9plus_context_set_word(&app->t9_context, gap_buffer_prefix(&app->text, app->caret) + last_word_pos);
+    t9_invalidate_layout(app);
 }
 
-// Helper function to cycle through suggestions
-static void t9_cycle_suggestion(TypeAidApp* app) {
-    if(app->cached_suggestion_count == 0) {
-        return;  // No suggestions to cycle through
+// Helper function to cycle through suggestions, returning false if there are none
+static bool t9_cycle_suggestion(TypeAidApp* app) {
+    t9_flush_suggestions(app);  // Earlier events of the batch may have changed the word
+    if(app->suggestions.count == 0) {
+        return false;  // No suggestions to cycle through
     }
     
     // Save original word on first cycle
     if(app->selected_suggestion == -1) {
-        size_t last_word_pos = get_last_word_start(app->text_buffer);
-        strncpy(app->original_word, app->text_buffer + last_word_pos, TEXT_BUFFER_SIZE - 1);
-        app->original_word[TEXT_BUFFER_SIZE - 1] = '\0';
+        size_t last_word_pos = get_last_word_start(app);
+        strncpy(app->original_word, gap_buffer_prefix(&app->text, app->caret) + last_word_pos, T9PLUS_MAX_WORD_LENGTH - 1);
+        app->original_word[T9PLUS_MAX_WORD_LENGTH - 1] = '\0';
     }
     
     // Move to next suggestion
     app->selected_suggestion++;
     
     // Wrap around: after last suggestion, go back to original
-    if(app->selected_suggestion >= (int8_t)app->cached_suggestion_count) {
+    if(app->selected_suggestion >= (int8_t)app->suggestions.count) {
         app->selected_suggestion = -1;
         // Restore original word
-        replace_last_word_with_suggestion(app, app->original_word);
+        replace_last_word_with_suggestion(app, app->original_word, strlen(app->original_word));
     } else {
-        // Show the selected suggestion in buffer
-        replace_last_word_with_suggestion(app, app->cached_suggestions[app->selected_suggestion]);
+        // Show the selected suggestion in buffer, straight from T9+
+        const T9PlusSuggestion* suggestion = &app->suggestions.items[app->selected_suggestion];
+        replace_last_word_with_suggestion(app, suggestion->word, suggestion->length);
     }
     
-    FURI_LOG_I(TAG, "Cycled to suggestion %d, buffer: '%s'", app->selected_suggestion, app->text_buffer);
+    T9PLUS_LOG_T(TAG, "Cycled to suggestion %d, text before caret: '%s'", app->selected_suggestion, gap_buffer_prefix(&app->text, app->caret));
+    return true;
 }
 
 // Helper function to accept currently selected suggestion
 static void t9_accept_suggestion(TypeAidApp* app) {
-    if(app->selected_suggestion >= 0 && app->selected_suggestion < (int8_t)app->cached_suggestion_count) {
+    if(app->selected_suggestion >= 0 && app->selected_suggestion < (int8_t)app->suggestions.count) {
         // Suggestion is already in buffer, add space, and just reset selection state
-        size_t current_len = strlen(app->text_buffer);
-        if(current_len < TEXT_BUFFER_SIZE - 1) {
-            app->text_buffer[current_len] = ' ';
-            app->text_buffer[current_len + 1] = '\0';
+        t9_learn_last_word(app, true);
+        if(t9_insert_char(app, ' ')) {
+            t9plus_context_push_char(&app->t9_context, ' ');
         }
         
         // Update suggestions for the newly accepted word
-        t9_update_suggestions(app);
+        t9_mark_suggestions_stale(app);
         
-        FURI_LOG_I(TAG, "Accepted suggestion, buffer: '%s'", app->text_buffer);
+        T9PLUS_LOG_T(TAG, "Accepted suggestion, text before caret: '%s'", gap_buffer_prefix(&app->text, app->caret));
     }
 }
 
-// Helper function to update suggestion cache when buffer changes
-static void t9_update_suggestions(TypeAidApp* app) {
-    // Only update if buffer has changed
-    if(strcmp(app->text_buffer, app->last_buffer_for_suggestions) == 0) {
-        return;  // Buffer unchanged, use cached suggestions
-    }
-    
+// Helper function to update the suggestions after the buffer changed, returning false if they
+// are the same words as before. The typing context already follows the caret, so this costs no
+// buffer scan, and the suggestions are not copied.
+static bool t9_update_suggestions(TypeAidApp* app) {
     // Buffer changed - reset selection state
     app->selected_suggestion = -1;
     app->original_word[0] = '\0';
     
-    // Update cache
-    strncpy(app->last_buffer_for_suggestions, app->text_buffer, TEXT_BUFFER_SIZE - 1);
-    app->last_buffer_for_suggestions[TEXT_BUFFER_SIZE - 1] = '\0';
-    
-    // Clear old suggestions
-    memset(app->cached_suggestions, 0, sizeof(app->cached_suggestions));
-    app->cached_suggestion_count = 0;
-    
-    // Get new suggestions
-    if(strlen(app->text_buffer) > 0) {
-        app->cached_suggestion_count = t9plus_get_suggestions(
-            app->text_buffer, 
-            app->cached_suggestions, 
-            T9PLUS_MAX_SUGGESTIONS
-        );
+    if(app->context_stale) {
+        t9_sync_context(app);
+    }
+    uint32_t generation = app->suggestions.generation;
+    t9plus_get_suggestion_list_ctx(&app->t9_context, &app->suggestions);
+    app->suggestions_stale = false;
+    return app->suggestions.generation != generation;
+}
+
+// Helper function to note that the buffer or the caret changed. The selection is reset at once,
+// the lookup waits for t9_flush_suggestions(), so a batch of events costs one lookup
+static void t9_mark_suggestions_stale(TypeAidApp* app) {
+    app->selected_suggestion = -1;
+    app->original_word[0] = '\0';
+    app->suggestions_stale = true;
+    t9_invalidate_layout(app);
+}
+
+// Helper function to look up the suggestions if they are stale
+static void t9_flush_suggestions(TypeAidApp* app) {
+    if(app->suggestions_stale) {
+        t9_update_suggestions(app);
     }
 }
 
+// Helper function to rebuild the typing context from the text before the caret,
+// needed whenever the caret moved or the text was edited other than at the caret
+static void t9_sync_context(TypeAidApp* app) {
+    t9plus_context_rebuild(&app->t9_context, gap_buffer_prefix(&app->text, app->caret), app->caret);
+    app->context_stale = false;
+}
+
+// Helper function to move the caret through the text, e.g. back to a typo. The typing context
+// is rebuilt once the batch of events is handled, however far the caret went
+static void t9_move_caret(TypeAidApp* app, int8_t delta) {
+    size_t length = gap_buffer_length(&app->text);
+    size_t caret;
+    if(delta < 0) {
+        caret = app->caret > (size_t)-delta ? app->caret + delta : 0;
+    } else {
+        caret = app->caret + delta < length ? app->caret + delta : length;
+    }
+    if(caret == app->caret) return;
+    app->caret = caret;
+    app->context_stale = true;
+    t9_mark_suggestions_stale(app);
+}
+
 static void t9_move_cursor(int8_t line_delta, int8_t pos_delta) {
     if(line_delta != 0) {
         int8_t new_line = t9_cursor.line + line_delta;
@@ -338,7 +509,7 @@ static void t9_move_cursor(int8_t line_delta, int8_t pos_delta) {
             t9_cursor.line = new_line;
             // Clamp position to new line length
             int8_t min_pos = (t9_cursor.line == SPECIAL_KEY_SHIFT_LINE || t9_cursor.line == SPECIAL_KEY_SPACE_LINE) ? -1 : 0;  // Lines with special buttons at -1
-            int8_t max_pos = strlen(t9_lines[t9_cursor.line]) - 1;
+            int8_t max_pos = t9_line_len[t9_cursor.line] - 1;
 			// Allow backspace position on line 0
 			if(t9_cursor.line == SPECIAL_KEY_BACK_LINE) max_pos++;
 			
@@ -353,7 +524,7 @@ static void t9_move_cursor(int8_t line_delta, int8_t pos_delta) {
     if(pos_delta != 0) {
         int8_t new_pos = t9_cursor.pos + pos_delta;
         int8_t min_pos = (t9_cursor.line == 3 || t9_cursor.line == 4) ? -1 : 0;
-        int8_t max_pos = strlen(t9_lines[t9_cursor.line]) - 1;
+        int8_t max_pos = t9_line_len[t9_cursor.line] - 1;
 		// Allow backspace position on line 0
         if(t9_cursor.line == SPECIAL_KEY_BACK_LINE) max_pos++;
         if(new_pos >= min_pos && new_pos <= max_pos) {
@@ -363,52 +534,242 @@ static void t9_move_cursor(int8_t line_delta, int8_t pos_delta) {
 }
 
 static void t9_add_character(TypeAidApp* app) {
+    // Edits at the caret update the typing context, which must follow the caret first
+    if(app->context_stale) {
+        t9_sync_context(app);
+    }
+    
     // Check if we're on line with the backspace button 
-    if(t9_cursor.line == SPECIAL_KEY_BACK_LINE && t9_cursor.pos == (int8_t)strlen(t9_lines[0])) {
-        size_t current_len = strlen(app->text_buffer);
-        if(current_len > 0) {
-            app->text_buffer[current_len - 1] = '\0';
-            FURI_LOG_I(TAG, "Deleted character, buffer now: '%s'", app->text_buffer);
-            t9_update_suggestions(app);
-            app->selected_suggestion = -1;
-            app->original_word[0] = '\0';
+    if(t9_cursor.line == SPECIAL_KEY_BACK_LINE && t9_cursor.pos == (int8_t)t9_line_len[SPECIAL_KEY_BACK_LINE]) {
+        if(app->caret > 0) {
+            gap_buffer_delete(&app->text, app->caret, 1);
+            app->caret--;
+            t9plus_context_pop_char(&app->t9_context, gap_buffer_prefix(&app->text, app->caret), app->caret);
+            T9PLUS_LOG_T(TAG, "Deleted character, text before caret: '%s'", gap_buffer_prefix(&app->text, app->caret));
+            t9_mark_suggestions_stale(app);
         }
         return;
     }
 	if(t9_cursor.line == SPECIAL_KEY_SHIFT_LINE && t9_cursor.pos == -1) { // Check if we are on the SHIFT button
         shift_locked = !shift_locked;
-        FURI_LOG_I(TAG, "Shift lock toggled: %s", shift_locked ? "ON" : "OFF");
+        T9PLUS_LOG_T(TAG, "Shift lock toggled: %s", shift_locked ? "ON" : "OFF");
         return;
     }
     if(t9_cursor.line == SPECIAL_KEY_SPACE_LINE && t9_cursor.pos == -1) { // Check if we are on the SPACE button
-        size_t current_len = strlen(app->text_buffer);
-        if(current_len < TEXT_BUFFER_SIZE - 1) {
-            app->text_buffer[current_len] = ' ';
-            app->text_buffer[current_len + 1] = '\0';
-            FURI_LOG_I(TAG, "Added space, buffer now: '%s'", app->text_buffer);
-            t9_update_suggestions(app);  // Update suggestions after adding space
+        if(gap_buffer_space(&app->text) > 0) {
+            t9_learn_last_word(app, app->selected_suggestion >= 0);
+            t9_insert_char(app, ' ');
+            t9plus_context_push_char(&app->t9_context, ' ');
+            T9PLUS_LOG_T(TAG, "Added space, text before caret: '%s'", gap_buffer_prefix(&app->text, app->caret));
+            t9_mark_suggestions_stale(app);  // Update suggestions after adding space
         }
         return;
     }
 	
     
-    size_t current_len = strlen(app->text_buffer);
-    if(current_len < TEXT_BUFFER_SIZE - 1) {
+    if(gap_buffer_space(&app->text) > 0) {
 		const char* line_str = shift_locked ? t9_lines_upper[t9_cursor.line] : t9_lines[t9_cursor.line];
         char ch = line_str[t9_cursor.pos];
-        app->text_buffer[current_len] = ch;
-        app->text_buffer[current_len + 1] = '\0';
-        FURI_LOG_I(TAG, "Added char '%c', buffer now: '%s'", ch, app->text_buffer);
-        t9_update_suggestions(app);  // Update suggestions after adding character
+        if(!t9plus_is_word_char(ch)) {
+            t9_learn_last_word(app, app->selected_suggestion >= 0);
+        }
+        t9_insert_char(app, ch);
+        t9plus_context_push_char(&app->t9_context, ch);
+        T9PLUS_LOG_T(TAG, "Added char '%c', text before caret: '%s'", ch, gap_buffer_prefix(&app->text, app->caret));
+        t9_mark_suggestions_stale(app);  // Update suggestions after adding character
     }
 }
 
 // ============================================================================
-// SPLASH SCREEN - DRAW CALLBACK
+// T9-MINUS SCREEN - EVENT HANDLING
 // ============================================================================
-static void splash_draw_callback(Canvas* canvas, void* context) {
-    FURI_LOG_D(TAG, "splash_draw_callback: enter");
+
+// Helper function to get how far a held arrow moves per event: one step, doubled every
+// T9_REPEAT_ACCEL_EVERY repeats up to T9_REPEAT_MAX_STEP
+static int8_t t9_repeat_step(TypeAidApp* app, const InputEvent* event) {
+    if(event->type != InputTypeRepeat) {
+        return 1;
+    }
+    int8_t step = 1;
+    for(uint8_t doublings = app->repeat_count / T9_REPEAT_ACCEL_EVERY; doublings > 0 && step < T9_REPEAT_MAX_STEP; doublings--) {
+        step *= 2;
+    }
+    if(app->repeat_count < UINT8_MAX) {
+        app->repeat_count++;
+    }
+    return step;
+}
+
+// Helper function to handle one event of the T9 screen other than Back, returning true if
+// the screen changed. Edits only mark the suggestions stale, see t9_flush_suggestions()
+static bool t9_handle_event(TypeAidApp* app, const InputEvent* event) {
+    if(event->type == InputTypePress) {
+        app->repeat_count = 0;
+        app->hold_cycled = false;
+        return false;
+    }
+    if(event->type == InputTypeRepeat) {
+        // Only the arrows repeat, and Right not after its long press cycled a suggestion
+        if(event->key == InputKeyOk || (event->key == InputKeyRight && app->hold_cycled)) {
+            return false;
+        }
+    } else if(event->type != InputTypeShort && event->type != InputTypeLong) {
+        return false;
+    }
+    int8_t step = t9_repeat_step(app, event);
+    
+    if(event->key == InputKeyOk) {
+        // If a suggestion is selected, accept it; otherwise add character
+        if(app->selected_suggestion >= 0) {
+            t9_accept_suggestion(app);
+        } else {
+            t9_add_character(app);
+        }
+    } else if(event->key == InputKeyUp) {
+#if T9PLUS_STATS
+        if(event->type == InputTypeLong) {
+            app->show_stats = !app->show_stats;
+            return true;
+        }
+#endif
+        for(int8_t i = 0; i < step; i++) {
+            t9_move_cursor(-1, 0);
+        }
+    } else if(event->key == InputKeyDown) {
+        for(int8_t i = 0; i < step; i++) {
+            t9_move_cursor(1, 0);
+        }
+    } else if(event->key == InputKeyLeft) {
+        // On the space line, which has no keys to move to, Left and Right move the caret
+        if(t9_cursor.line == SPECIAL_KEY_SPACE_LINE) {
+            t9_move_caret(app, -step);
+        } else {
+            for(int8_t i = 0; i < step; i++) {
+                t9_move_cursor(0, -1);
+            }
+        }
+    } else if(event->key == InputKeyRight) {
+        // Short press or held: move cursor
+        // Long press: cycle through suggestions
+        if(event->type == InputTypeLong) {
+            app->hold_cycled = t9_cycle_suggestion(app);
+        } else if(t9_cursor.line == SPECIAL_KEY_SPACE_LINE) {
+            t9_move_caret(app, step);
+        } else {
+            for(int8_t i = 0; i < step; i++) {
+                t9_move_cursor(0, 1);
+            }
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// SCREEN SWITCHING
+// ============================================================================
+
+// Helper function to show one of the app's views
+static void type_aid_show(TypeAidApp* app, TypeAidView view) {
+    app->current_view = view;
+    view_dispatcher_switch_to_view(app->view_dispatcher, view);
+}
+
+// Helper function to open the T9 screen
+static void t9_open(TypeAidApp* app) {
+    FURI_LOG_I(TAG, "OK pressed, showing T9 input");
+    // The standard keyboard may have changed the buffer
+    t9_sync_context(app);
+    t9_update_suggestions(app);
+    t9_invalidate_layout(app);
+    app->suggestions_ready = t9plus_is_ready();
+    type_aid_show(app, TypeAidViewT9);
+    t9_redraw(app);
+}
+
+// Helper function to leave the T9 screen for the splash screen
+static void t9_close(TypeAidApp* app) {
+    FURI_LOG_I(TAG, "Back pressed in T9, returning to splash");
+    t9_cursor.line = 0;
+    t9_cursor.pos = 0;
+	app->keyboard_used = true;  // Mark keyboard as used
+	shift_locked = false;  // Reset shift lock
+    furi_timer_stop(app->blink_timer);
+    gap_buffer_text(&app->text);  // Close the gap for the splash draw callback, which only reads
+    type_aid_show(app, TypeAidViewSplash);
+}
+
+// Helper function to take the text back from the standard keyboard, done or left with Back
+static void text_input_close(TypeAidApp* app) {
+    FURI_LOG_I(TAG, "Text input closed, returning to splash");
+    gap_buffer_set(&app->text, app->text_input_buffer);
+    app->caret = gap_buffer_length(&app->text);
+    free(app->text_input_buffer);
+    app->text_input_buffer = NULL;
+    type_aid_show(app, TypeAidViewSplash);
+}
+
+static void text_input_callback(void* context) {
+    FURI_LOG_I(TAG, "text_input_callback: text entered");
     TypeAidApp* app = context;
+
+    if(!app) {
+        FURI_LOG_E(TAG, "text_input_callback: app is NULL!");
+        return;
+    }
+
+    FURI_LOG_I(TAG, "Text entered: '%s'", app->text_input_buffer);
+    text_input_close(app);
+}
+
+// Helper function to open the standard keyboard
+static void text_input_open(TypeAidApp* app) {
+    FURI_LOG_I(TAG, "Down/Right pressed, showing text input");
+    app->keyboard_used = true; // Flag that keyboard has been used at least once
+
+    // Show text input on a flat copy of the text, only allocated while it is open
+    app->text_input_buffer = malloc(TEXT_BUFFER_SIZE);
+    strncpy(app->text_input_buffer, gap_buffer_text(&app->text), TEXT_BUFFER_SIZE - 1);
+    app->text_input_buffer[TEXT_BUFFER_SIZE - 1] = '\0';
+    text_input_set_result_callback(
+        app->text_input,
+        text_input_callback,
+        app,
+        app->text_input_buffer,
+        TEXT_BUFFER_SIZE,
+        false
+    );
+    type_aid_show(app, TypeAidViewTextInput);
+}
+
+// ============================================================================
+// T9-MINUS SCREEN - INPUT CALLBACK
+// ============================================================================
+
+// Input callback of the T9 view. Events are handled at once, but the lookup and the redraw
+// wait for one TypeAidEventFlush, so the events of a burst share them
+static bool t9_input_callback(InputEvent* input_event, void* context) {
+    TypeAidApp* app = context;
+    if(input_event->key == InputKeyBack) {
+        if(input_event->type == InputTypeShort || input_event->type == InputTypeLong) {
+            t9_close(app);
+        }
+        return true;
+    }
+    if(t9_handle_event(app, input_event) && !app->flush_pending) {
+        app->flush_pending = true;
+        view_dispatcher_send_custom_event(app->view_dispatcher, TypeAidEventFlush);
+    }
+    return true;
+}
+
+// ============================================================================
+// SPLASH SCREEN - DRAW CALLBACK
+// ============================================================================
+static void splash_draw_callback(Canvas* canvas, void* model) {
+    T9PLUS_LOG_T(TAG, "splash_draw_callback: enter");
+    TypeAidApp* app = ((TypeAidViewModel*)model)->app;
     
     if(!app) {
         FURI_LOG_E(TAG, "splash_draw_callback: app is NULL!");
@@ -425,19 +786,33 @@ static void splash_draw_callback(Canvas* canvas, void* context) {
     canvas_draw_icon(canvas, 1, 1, &I_icon_10x10);
     canvas_set_font(canvas, FontPrimary);
     canvas_draw_str_aligned(canvas, 12, 1, AlignLeft, AlignTop, "Type Aid v0.1");
+    uint16_t language_x = 12 + canvas_string_width(canvas, "Type Aid v0.1") + 4;
     
     canvas_set_color(canvas, ColorBlack);
     canvas_set_font(canvas, FontSecondary);
     
+    // Language pack after the title, switched with Left
+    char language[8];
+    snprintf(language, sizeof(language), "<%s", t9plus_get_language_name(t9plus_get_language()));
+    canvas_draw_str_aligned(canvas, language_x, 2, AlignLeft, AlignTop, language);
+    
     
     // Display entered text inside the box (truncated, no scrolling)
-    if(strlen(app->text_buffer) > 0) {
+    if(gap_buffer_length(&app->text) > 0) {
        canvas_draw_frame(canvas, 0, 16, 128, 35);
-       elements_multiline_text(canvas, 2, 25, app->text_buffer);
+       elements_multiline_text(canvas, 2, 25, gap_buffer_flat(&app->text));
     } else {
         // Show placeholder text when no input yet
         canvas_draw_str_aligned(canvas, 1, 17, AlignLeft, AlignTop, "Try different");
         canvas_draw_str_aligned(canvas, 1, 26, AlignLeft, AlignTop, "keyboards");
+        
+        // Progress of the word list loading in the background
+        uint8_t progress = t9plus_get_load_progress();
+        if(progress < 100) {
+            char loading[24];
+            snprintf(loading, sizeof(loading), "Loading words %u%%", progress);
+            canvas_draw_str_aligned(canvas, 1, 35, AlignLeft, AlignTop, loading);
+        }
     }	
 	
 
@@ -447,41 +822,124 @@ static void splash_draw_callback(Canvas* canvas, void* context) {
 	canvas_draw_icon(canvas, 1, 55, &I_back);
 	canvas_draw_str_aligned(canvas, 11, 63, AlignLeft, AlignBottom, "Exit");	
     
-    FURI_LOG_D(TAG, "splash_draw_callback: exit");
+    T9PLUS_LOG_T(TAG, "splash_draw_callback: exit");
 }
 
 // ============================================================================
 // SPLASH SCREEN - INPUT CALLBACK
 // ============================================================================
 
-static void splash_input_callback(InputEvent* input_event, void* context) {
+static bool splash_input_callback(InputEvent* input_event, void* context) {
     TypeAidApp* app = context;
-    furi_message_queue_put(app->event_queue, input_event, FuriWaitForever);
+    if(input_event->type != InputTypeShort && input_event->type != InputTypeLong) {
+        return false;
+    }
+    
+    if(input_event->key == InputKeyBack) {
+        FURI_LOG_I(TAG, "Back pressed, exiting");
+        view_dispatcher_stop(app->view_dispatcher);
+    }
+    else if(input_event->key == InputKeyOk) {
+        t9_open(app);
+    }
+    else if(input_event->key == InputKeyLeft) {
+        // Next language pack; packs that are not installed are skipped
+        uint8_t count = t9plus_get_language_count();
+        for(uint8_t step = 1; step < count; step++) {
+            if(t9plus_set_language((t9plus_get_language() + step) % count)) {
+                FURI_LOG_I(TAG, "Language: %s", t9plus_get_language_name(t9plus_get_language()));
+                t9_apply_language();
+                break;
+            }
+        }
+        type_aid_redraw(app->splash_view);
+    }
+    else if(input_event->key == InputKeyDown || input_event->key == InputKeyRight) {
+        text_input_open(app);
+    }
+    return true;
 }
 
 // ============================================================================
-// TEXT INPUT - CALLBACK
+// VIEW DISPATCHER - CALLBACKS
 // ============================================================================
 
-static void text_input_callback(void* context) {
-    FURI_LOG_I(TAG, "text_input_callback: text entered");
+// Custom event callback, on the app thread like every other callback of the views
+static bool type_aid_custom_event_callback(void* context, uint32_t event) {
     TypeAidApp* app = context;
     
-    if(!app) {
-        FURI_LOG_E(TAG, "text_input_callback: app is NULL!");
-        return;
+    if(event == TypeAidEventFlush) {
+        app->flush_pending = false;
+        if(app->current_view == TypeAidViewT9) {
+            t9_flush_suggestions(app);
+            t9_redraw(app);
+        }
+    } else if(event == TypeAidEventBlink) {
+        // Only the cursor changes, nothing else on the screen
+        if(app->current_view == TypeAidViewT9) {
+            app->cursor_visible = !app->cursor_visible;
+            type_aid_redraw(app->t9_view);
+        }
+    } else if(event == TypeAidEventLoad) {
+        __atomic_store_n(&app->load_event_pending, false, __ATOMIC_RELEASE);
+        if(app->current_view == TypeAidViewT9 && !app->suggestions_ready && t9plus_is_ready()) {
+            // The lexicon finished loading in the background: replace "loading..."
+            app->suggestions_ready = true;
+            t9_sync_context(app);  // Words typed so far can now be matched against frames
+            t9_update_suggestions(app);
+            type_aid_redraw(app->t9_view);
+        } else if(app->current_view == TypeAidViewT9 && app->suggestions_ready && app->selected_suggestion < 0) {
+            // Tiers loaded later may improve the suggestions; redraw only if they changed
+            if(t9_update_suggestions(app)) {
+                type_aid_redraw(app->t9_view);
+            }
+        } else if(app->current_view == TypeAidViewSplash && t9plus_get_load_progress() != app->splash_progress) {
+            // The load progress is all that changes on the idle splash screen
+            app->splash_progress = t9plus_get_load_progress();
+            type_aid_redraw(app->splash_view);
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Navigation callback: Back in the standard keyboard returns to the splash screen with its
+// text. The splash and T9 views handle Back themselves
+static bool type_aid_navigation_callback(void* context) {
+    TypeAidApp* app = context;
+    if(app->current_view == TypeAidViewTextInput) {
+        text_input_close(app);
+        return true;
+    }
+    return false;  // Stops the view dispatcher
+}
+
+// Load callback, on the loader thread: only wakes the app, with at most one event queued
+static void type_aid_load_callback(void* context) {
+    TypeAidApp* app = context;
+    if(!__atomic_exchange_n(&app->load_event_pending, true, __ATOMIC_ACQ_REL)) {
+        view_dispatcher_send_custom_event(app->view_dispatcher, TypeAidEventLoad);
     }
-    
-    FURI_LOG_I(TAG, "Text entered: '%s'", app->text_buffer);
-    
-    // Stop the view dispatcher to return to main loop
-    view_dispatcher_stop(app->view_dispatcher);
 }
 
 // ============================================================================
 // APP LIFECYCLE - ALLOCATION
 // ============================================================================
 
+// Helper function to allocate one of the app's own views, drawn from the app's state
+static View* type_aid_view_alloc(TypeAidApp* app, ViewDrawCallback draw_callback, ViewInputCallback input_callback) {
+    View* view = view_alloc();
+    view_set_context(view, app);
+    view_set_draw_callback(view, draw_callback);
+    view_set_input_callback(view, input_callback);
+    view_allocate_model(view, ViewModelTypeLockFree, sizeof(TypeAidViewModel));
+    TypeAidViewModel* model = view_get_model(view);
+    model->app = app;
+    view_commit_model(view, false);
+    return view;
+}
+
 static TypeAidApp* type_aid_app_alloc() {
     FURI_LOG_I(TAG, "=== App allocation started ===");
     
@@ -491,55 +949,46 @@ static TypeAidApp* type_aid_app_alloc() {
     FURI_LOG_D(TAG, "Opening GUI");
     app->gui = furi_record_open(RECORD_GUI);
     
-    FURI_LOG_D(TAG, "Creating event queue");
-    app->event_queue = furi_message_queue_alloc(8, sizeof(InputEvent));
-    
-    FURI_LOG_D(TAG, "Creating viewport for splash");
-    app->view_port = view_port_alloc();
-    view_port_draw_callback_set(app->view_port, splash_draw_callback, app);
-    view_port_input_callback_set(app->view_port, splash_input_callback, app);
-    
-    FURI_LOG_D(TAG, "Creating viewport for T9");
-    app->t9_view_port = view_port_alloc();
-    view_port_draw_callback_set(app->t9_view_port, t9_draw_callback, app);
-    view_port_input_callback_set(app->t9_view_port, t9_input_callback, app);
-    
     FURI_LOG_D(TAG, "Creating view dispatcher");
     app->view_dispatcher = view_dispatcher_alloc();
+    view_dispatcher_set_event_callback_context(app->view_dispatcher, app);
+    view_dispatcher_set_custom_event_callback(app->view_dispatcher, type_aid_custom_event_callback);
+    view_dispatcher_set_navigation_event_callback(app->view_dispatcher, type_aid_navigation_callback);
+    
+    FURI_LOG_D(TAG, "Creating view for splash");
+    app->splash_view = type_aid_view_alloc(app, splash_draw_callback, splash_input_callback);
+    
+    FURI_LOG_D(TAG, "Creating view for T9");
+    app->t9_view = type_aid_view_alloc(app, t9_draw_callback, t9_input_callback);
+    app->blink_timer = furi_timer_alloc(t9_blink_callback, FuriTimerTypePeriodic, app);
     
     FURI_LOG_D(TAG, "Creating text input");
     app->text_input = text_input_alloc();
     text_input_set_header_text(app->text_input, "Enter your text:");
-    text_input_set_result_callback(
-        app->text_input,
-        text_input_callback,
-        app,
-        app->text_buffer,
-        TEXT_BUFFER_SIZE,
-        false
-    );
     
-    // Add text input to view dispatcher
-    view_dispatcher_add_view(app->view_dispatcher, 1, text_input_get_view(app->text_input));
+    view_dispatcher_add_view(app->view_dispatcher, TypeAidViewSplash, app->splash_view);
+    view_dispatcher_add_view(app->view_dispatcher, TypeAidViewTextInput, text_input_get_view(app->text_input));
+    view_dispatcher_add_view(app->view_dispatcher, TypeAidViewT9, app->t9_view);
     view_dispatcher_attach_to_gui(app->view_dispatcher, app->gui, ViewDispatcherTypeFullscreen);
     
-    FURI_LOG_D(TAG, "Adding splash viewport to GUI");
-    gui_add_view_port(app->gui, app->view_port, GuiLayerFullscreen);
-    
-    app->in_text_input = false;
+    gap_buffer_init(&app->text, TEXT_BUFFER_SIZE - 1);
+    app->caret = 0;
     app->keyboard_used = false;  // Initially, keyboard hasn't been used
-	
-	// Initialize suggestion cache
-	memset(app->cached_suggestions, 0, sizeof(app->cached_suggestions));
-	app->cached_suggestion_count = 0;
-	memset(app->last_buffer_for_suggestions, 0, sizeof(app->last_buffer_for_suggestions));
-	
+    
+	// Initialize suggestions
+	app->suggestions.count = 0;
+    
 	// Initialize suggestion selection state
 	app->selected_suggestion = -1;
 	memset(app->original_word, 0, sizeof(app->original_word));
-	
-	t9plus_init(); // Initialize T9+ prediction system
-	
+    
+	t9plus_set_load_callback(type_aid_load_callback, app);  // Redraws the load progress
+	t9plus_init(); // Initialize T9+ prediction system, loads the lexicon in the background
+	t9_apply_language();
+    
+    FURI_LOG_D(TAG, "Showing splash");
+    type_aid_show(app, TypeAidViewSplash);
+    
     FURI_LOG_I(TAG, "=== App allocation complete ===");
     return app;
 }
@@ -551,20 +1000,22 @@ static TypeAidApp* type_aid_app_alloc() {
 static void type_aid_app_free(TypeAidApp* app) {
     FURI_LOG_I(TAG, "=== App cleanup started ===");
     
-    gui_remove_view_port(app->gui, app->view_port);
-    view_port_free(app->view_port);
-    view_port_free(app->t9_view_port);
+    furi_timer_stop(app->blink_timer);
+    furi_timer_free(app->blink_timer);
+    t9plus_deinit(); // Clean up T9+ prediction system; waits for the loader, which sends events
     
-    view_dispatcher_remove_view(app->view_dispatcher, 1);
+    view_dispatcher_remove_view(app->view_dispatcher, TypeAidViewSplash);
+    view_dispatcher_remove_view(app->view_dispatcher, TypeAidViewTextInput);
+    view_dispatcher_remove_view(app->view_dispatcher, TypeAidViewT9);
+    view_free(app->splash_view);
     text_input_free(app->text_input);
+    view_free(app->t9_view);
     view_dispatcher_free(app->view_dispatcher);
     
-    furi_message_queue_free(app->event_queue);
     furi_record_close(RECORD_GUI);
+    gap_buffer_free(&app->text);
     free(app);
     
-    t9plus_deinit(); // Clean up T9+ prediction system
-	
     FURI_LOG_I(TAG, "=== App cleanup complete ===");
 }
 
@@ -577,97 +1028,14 @@ int32_t type_aid_main(void* p) {
     
     FURI_LOG_I(TAG, "App TYAID starting");
     TypeAidApp* app = type_aid_app_alloc();
-    InputEvent event;
-    
-    bool in_t9_mode = false;
     
+    // Input, the blink timer and the background load all arrive as view dispatcher events,
+    // so the app thread sleeps until one of them comes; nothing polls
     FURI_LOG_I(TAG, "Entering main event loop"); // --------------------------
-    while(1) {
-        if(app->in_text_input) {
-            // We're waiting for text input to finish
-            furi_delay_ms(100); 
-        } else {
-            // Handle events based on current mode
-            if(furi_message_queue_get(app->event_queue, &event, 100) == FuriStatusOk) {
-                
-                if(in_t9_mode) {
-                    // T9 mode event handling
-                    if(event.type == InputTypeShort || event.type == InputTypeLong) {
-                        if(event.key == InputKeyBack) {
-                            FURI_LOG_I(TAG, "Back pressed in T9, returning to splash");
-                            in_t9_mode = false;
-                            t9_cursor.line = 0;
-                            t9_cursor.pos = 0;
-							app->keyboard_used = true;  // Mark keyboard as used
-							shift_locked = false;  // Reset shift lock
-                            gui_remove_view_port(app->gui, app->t9_view_port);
-                            gui_add_view_port(app->gui, app->view_port, GuiLayerFullscreen);
-                        } else if(event.key == InputKeyOk) {
-                            // If a suggestion is selected, accept it; otherwise add character
-                            if(app->selected_suggestion >= 0) {
-                                t9_accept_suggestion(app);
-                            } else {
-                                t9_add_character(app);
-                            }
-                            view_port_update(app->t9_view_port);
-                        } else if(event.key == InputKeyUp) {
-                            t9_move_cursor(-1, 0);
-                            view_port_update(app->t9_view_port);
-                        } else if(event.key == InputKeyDown) {
-                            t9_move_cursor(1, 0);
-                            view_port_update(app->t9_view_port);
-                        } else if(event.key == InputKeyLeft) {
-                            t9_move_cursor(0, -1);
-                            view_port_update(app->t9_view_port);
-                        } else if(event.key == InputKeyRight) {
-                            // Short press: move cursor
-                            // Long press: cycle through suggestions
-                            if(event.type == InputTypeLong) {
-                                t9_cycle_suggestion(app);
-                            } else {
-                                t9_move_cursor(0, 1);
-                            }
-                            view_port_update(app->t9_view_port);
-                        }
-                    }
-                } else if(event.type == InputTypeShort || event.type == InputTypeLong) {
-                    // Splash screen event handling
-                    if(event.key == InputKeyBack) {
-                        FURI_LOG_I(TAG, "Back pressed, exiting");
-                        break;
-                    }
-                    else if(event.key == InputKeyOk) {
-                        FURI_LOG_I(TAG, "OK pressed, showing T9 input");
-                        in_t9_mode = true;
-                        gui_remove_view_port(app->gui, app->view_port);
-                        gui_add_view_port(app->gui, app->t9_view_port, GuiLayerFullscreen);
-                    }
-                    else if(event.key == InputKeyDown || event.key == InputKeyRight) {
-                        FURI_LOG_I(TAG, "Down/Right pressed, showing text input");
-                        app->keyboard_used = true; // Flag that keyboard has been used at least once
-                        gui_remove_view_port(app->gui, app->view_port); // Remove splash screen
-                        
-                        // Show text input
-                        app->in_text_input = true;
-                        view_dispatcher_switch_to_view(app->view_dispatcher, 1);
-                        view_dispatcher_run(app->view_dispatcher);
-                        
-                        // Text input finished, show splash again
-                        FURI_LOG_I(TAG, "Text input closed, returning to splash");
-                        app->in_text_input = false;
-                        gui_add_view_port(app->gui, app->view_port, GuiLayerFullscreen);
-                        view_port_update(app->view_port);
-                    }
-                }
-            }
-            
-            if(!in_t9_mode) {
-                view_port_update(app->view_port);
-            }
-        }
-    }
+    view_dispatcher_run(app->view_dispatcher);
+    
     FURI_LOG_I(TAG, "Cleaning up");
     type_aid_app_free(app);
     FURI_LOG_I(TAG, "App exiting");
     return 0;
-}
\ No newline at end of file
+}